@@ -0,0 +1,342 @@
+/**
+ * This hpp file defines the AlphabetTrie, a multi-way trie for
+ * dictionaries whose words only use a small, fixed alphabet, with
+ * the alphabet traits and the node policies it is specialized on
+ *
+ * The alphabet maps every symbol to a dense index at compile time,
+ * so a node can find the child for a letter by direct indexing
+ * instead of walking a ternary search tree. The generic
+ * DictionaryTrie stays the choice for arbitrary characters.
+ */
+#ifndef ALPHABET_TRIE_HPP
+#define ALPHABET_TRIE_HPP
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+#include "DictionaryTrie.hpp"
+
+using namespace std;
+
+/* lowercase ASCII letters, space and apostrophe */
+struct LowercaseAlphabet {
+    static constexpr unsigned int SIZE = 28;
+
+    /* index of a symbol, -1 if it is not in the alphabet */
+    static constexpr int index(char c) {
+        return c >= 'a' && c <= 'z' ? c - 'a'
+                                    : c == ' ' ? 26 : c == '\'' ? 27 : -1;
+    }
+
+    /* symbol of an index */
+    static constexpr char symbol(unsigned int i) {
+        return i < 26 ? 'a' + i : i == 26 ? ' ' : '\'';
+    }
+};
+
+/* children as an array indexed by symbol: one lookup per letter,
+ * 4 bytes per symbol of the alphabet in every node
+ */
+struct DenseChildren {
+    template <class Alphabet>
+    class Children {
+      private:
+        array<uint32_t, Alphabet::SIZE> nodes;
+
+      public:
+        Children() { nodes.fill(0); }
+
+        /* node of the child at a symbol index, 0 if there is none */
+        uint32_t get(unsigned int i) const { return nodes[i]; }
+
+        void set(unsigned int i, uint32_t node) { nodes[i] = node; }
+
+        /* bytes held outside the node */
+        size_t heapBytes() const { return 0; }
+
+        /* calls visit(index, node) for every child in symbol order */
+        template <class Visitor>
+        void forEach(Visitor visit) const {
+            for (unsigned int i = 0; i < Alphabet::SIZE; i++) {
+                if (nodes[i] != 0) {
+                    visit(i, nodes[i]);
+                }
+            }
+        }
+    };
+};
+
+/* children as a bitmap of present symbols and a list of nodes:
+ * a popcount per lookup, memory in proportion to the real fan-out.
+ * Needs an alphabet of at most 64 symbols
+ */
+struct BitmapChildren {
+    template <class Alphabet>
+    class Children {
+        static_assert(Alphabet::SIZE <= 64,
+                      "BitmapChildren needs at most 64 symbols");
+
+      private:
+        uint64_t present;
+        vector<uint32_t> nodes;  // in symbol order
+
+        /* position in nodes of the child at symbol index i */
+        unsigned int rank(unsigned int i) const {
+            return __builtin_popcountll(present & (((uint64_t)1 << i) - 1));
+        }
+
+      public:
+        Children() : present(0) {}
+
+        /* node of the child at a symbol index, 0 if there is none */
+        uint32_t get(unsigned int i) const {
+            return (present >> i) & 1 ? nodes[rank(i)] : 0;
+        }
+
+        void set(unsigned int i, uint32_t node) {
+            if ((present >> i) & 1) {
+                nodes[rank(i)] = node;
+            } else {
+                nodes.insert(nodes.begin() + rank(i), node);
+                present |= (uint64_t)1 << i;
+            }
+        }
+
+        /* bytes held outside the node */
+        size_t heapBytes() const {
+            return nodes.capacity() * sizeof(uint32_t);
+        }
+
+        /* calls visit(index, node) for every child in symbol order */
+        template <class Visitor>
+        void forEach(Visitor visit) const {
+            uint64_t remaining = present;
+            for (unsigned int j = 0; remaining != 0; j++) {
+                unsigned int i = __builtin_ctzll(remaining);
+                visit(i, nodes[j]);
+                remaining &= remaining - 1;
+            }
+        }
+    };
+};
+
+/**
+ * A multi-way trie over a fixed alphabet. Nodes live in one vector
+ * and refer to their children by position, node 0 is the root.
+ * Every node keeps the highest frequency below it so queries can
+ * skip subtries that cannot make the top numCompletions.
+ */
+template <class Alphabet, class NodePolicy = DenseChildren>
+class AlphabetTrie {
+  private:
+    struct Node {
+        typename NodePolicy::template Children<Alphabet> children;
+        unsigned int frequency = 0;
+        unsigned int maxFrequency = 0;  // maximum frequency of the subtrie
+        bool isWordNode = false;
+    };
+
+    vector<Node> nodes;
+    size_t numWords;
+
+    /* pushes a word, keeping only the numCompletions best */
+    static void offer(WordPQ& completions, unsigned int numCompletions,
+                      unsigned int freq, const string& word) {
+        if (completions.size() < numCompletions) {
+            completions.push(pair<int, string>(freq, word));
+        } else if (completions.top().first < (int)freq) {
+            completions.pop();
+            completions.push(pair<int, string>(freq, word));
+        }
+    }
+
+    /* true if no word below node can make the numCompletions best */
+    bool prune(const WordPQ& completions, unsigned int numCompletions,
+               uint32_t node) const {
+        return completions.size() == numCompletions &&
+               (int)nodes[node].maxFrequency <= completions.top().first;
+    }
+
+    /* node a word or prefix ends at, 0 if there is none */
+    uint32_t findNode(const string& prefix) const {
+        if (numWords == 0) {
+            return 0;
+        }
+        uint32_t node = 0;
+        for (unsigned int i = 0; i < prefix.length(); i++) {
+            int index = Alphabet::index(prefix[i]);
+            if (index < 0) {
+                return 0;
+            }
+            node = nodes[node].children.get(index);
+            if (node == 0) {
+                return 0;
+            }
+        }
+        return node;
+    }
+
+    /* depth first search for prefix (helper for predict) */
+    void depthFirst(uint32_t node, string& word, unsigned int numCompletions,
+                    WordPQ& completions) const {
+        if (nodes[node].isWordNode) {
+            offer(completions, numCompletions, nodes[node].frequency, word);
+        }
+        nodes[node].children.forEach([&](unsigned int i, uint32_t child) {
+            if (!prune(completions, numCompletions, child)) {
+                word.push_back(Alphabet::symbol(i));
+                depthFirst(child, word, numCompletions, completions);
+                word.pop_back();
+            }
+        });
+    }
+
+    /* underscore helper, matches pattern[index...] below node */
+    void matchPattern(uint32_t node, const string& pattern,
+                      unsigned int index, string& word,
+                      unsigned int numCompletions,
+                      WordPQ& completions) const {
+        if (index == pattern.length()) {
+            if (nodes[node].isWordNode) {
+                offer(completions, numCompletions, nodes[node].frequency,
+                      word);
+            }
+            return;
+        }
+
+        auto visit = [&](unsigned int i, uint32_t child) {
+            if (!prune(completions, numCompletions, child)) {
+                word.push_back(Alphabet::symbol(i));
+                matchPattern(child, pattern, index + 1, word,
+                             numCompletions, completions);
+                word.pop_back();
+            }
+        };
+
+        if (pattern[index] == '_') {
+            nodes[node].children.forEach(visit);
+        } else {
+            int i = Alphabet::index(pattern[index]);
+            uint32_t child = i < 0 ? 0 : nodes[node].children.get(i);
+            if (child != 0) {
+                visit(i, child);
+            }
+        }
+    }
+
+    /* moves the queue into a vector, lowest ranked first */
+    static vector<string> drain(WordPQ& completions) {
+        vector<string> completionSet;
+        while (!completions.empty()) {
+            completionSet.push_back(completions.top().second);
+            completions.pop();
+        }
+        return completionSet;
+    }
+
+  public:
+    /* Initializes an empty trie */
+    AlphabetTrie() : nodes(1), numWords(0) {}
+
+    /* true if every symbol of word is in the alphabet */
+    static bool accepts(const string& word) {
+        for (unsigned int i = 0; i < word.length(); i++) {
+            if (Alphabet::index(word[i]) < 0) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /* inserts a new word into the dictionary
+     * @return true if inserted, false if duplicate or if the word
+     * uses a symbol outside the alphabet
+     **/
+    bool insert(const string& word, unsigned int freq) {
+        if (word.length() == 0 || freq == 0 || !accepts(word) ||
+            find(word)) {
+            return false;
+        }
+
+        uint32_t node = 0;
+        for (unsigned int i = 0; i < word.length(); i++) {
+            if (nodes[node].maxFrequency < freq) {
+                nodes[node].maxFrequency = freq;
+            }
+            int index = Alphabet::index(word[i]);
+            uint32_t child = nodes[node].children.get(index);
+            if (child == 0) {
+                child = nodes.size();
+                nodes[node].children.set(index, child);
+                nodes.push_back(Node());  // may move nodes, so set first
+            }
+            node = child;
+        }
+
+        Node& last = nodes[node];
+        last.isWordNode = true;
+        last.frequency = freq;
+        if (last.maxFrequency < freq) {
+            last.maxFrequency = freq;
+        }
+        numWords++;
+        return true;
+    }
+
+    /* finds a word in the dictionary
+     * @return true if found false otherwise
+     **/
+    bool find(const string& word) const {
+        uint32_t node = findNode(word);
+        return node != 0 && nodes[node].isWordNode;
+    }
+
+    /* predicts words given a prefix based on words with
+     * the highest frequencies
+     * @return a vector of suggested completions, same order as
+     * DictionaryTrie::predictCompletions
+     **/
+    vector<string> predictCompletions(const string& prefix,
+                                      unsigned int numCompletions) const {
+        WordPQ completions;
+        uint32_t node = findNode(prefix);
+        if (numCompletions > 0 && node != 0) {
+            string word = prefix;
+            depthFirst(node, word, numCompletions, completions);
+        }
+        return drain(completions);
+    }
+
+    /* predicts words given a pattern with underscores
+     * @return a vector of suggested completions, same order as
+     * DictionaryTrie::predictUnderscores
+     **/
+    vector<string> predictUnderscores(const string& pattern,
+                                      unsigned int numCompletions) const {
+        WordPQ completions;
+        if (numCompletions > 0 && pattern.length() > 0) {
+            string word;
+            matchPattern(0, pattern, 0, word, numCompletions, completions);
+        }
+        return drain(completions);
+    }
+
+    /* number of words stored */
+    size_t size() const { return numWords; }
+
+    /* number of nodes, root included */
+    size_t nodeCount() const { return nodes.size(); }
+
+    /* bytes held by the nodes, not counting allocator overhead */
+    size_t sizeInBytes() const {
+        size_t bytes = sizeof(*this) + nodes.capacity() * sizeof(Node);
+        for (size_t i = 0; i < nodes.size(); i++) {
+            bytes += nodes[i].children.heapBytes();
+        }
+        return bytes;
+    }
+};
+
+#endif  // ALPHABET_TRIE_HPP
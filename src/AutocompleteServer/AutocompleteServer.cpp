@@ -0,0 +1,513 @@
+/**
+ * This file implements the AutocompleteServer
+ * defined in AutocompleteServer.hpp
+ */
+#include "AutocompleteServer.hpp"
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+/* longest request line accepted before the connection is dropped */
+static const size_t MAX_REQUEST = 64 * 1024;
+/* events handled per epoll_wait */
+static const int MAX_EVENTS = 64;
+
+/**
+ * Server constructor
+ * @param dict the dictionary every query is answered from
+ * @param numWorkers the number of threads running queries
+ * @param maxVisits the most nodes one query may visit, 0 for no limit
+ * @param timeLimit the longest one query may run, 0 for no limit
+ */
+AutocompleteServer::AutocompleteServer(const DictionaryTrie& dict,
+                                       unsigned int numWorkers,
+                                       unsigned long long maxVisits,
+                                       chrono::nanoseconds timeLimit)
+    : dict(dict),
+      numWorkers(numWorkers == 0 ? 1 : numWorkers),
+      maxVisits(maxVisits),
+      timeLimit(timeLimit),
+      listenFd(-1),
+      epollFd(epoll_create1(EPOLL_CLOEXEC)),
+      wakeFd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)),
+      setupError(0),
+      stopping(false),
+      nextConnection(0) {
+    epoll_event event;
+    event.events = EPOLLIN;
+    event.data.fd = wakeFd;
+    if (epollFd < 0 || wakeFd < 0 ||
+        epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event) < 0) {
+        // reported by listen(), the server cannot run
+        setupError = errno;
+        if (epollFd >= 0) {
+            close(epollFd);
+            epollFd = -1;
+        }
+    }
+}
+
+/* binds and listens on a Unix socket, replacing a stale socket file
+ * @return true on success, false with a message on cerr otherwise
+ **/
+bool AutocompleteServer::listen(const string& path) {
+    if (epollFd < 0) {
+        cerr << "Cannot create the event loop: " << strerror(setupError)
+             << endl;
+        return false;
+    }
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.length() >= sizeof(address.sun_path)) {
+        cerr << "Socket path too long: " << path << endl;
+        return false;
+    }
+    strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+
+    listenFd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    if (listenFd < 0) {
+        cerr << "socket: " << strerror(errno) << endl;
+        return false;
+    }
+    unlink(path.c_str());
+    if (::bind(listenFd, (sockaddr*)&address, sizeof(address)) < 0 ||
+        ::listen(listenFd, SOMAXCONN) < 0) {
+        cerr << "Cannot listen on " << path << ": " << strerror(errno)
+             << endl;
+        close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+
+    epoll_event event;
+    event.events = EPOLLIN;
+    event.data.fd = listenFd;
+    if (epoll_ctl(epollFd, EPOLL_CTL_ADD, listenFd, &event) < 0) {
+        cerr << "epoll_ctl: " << strerror(errno) << endl;
+        close(listenFd);
+        listenFd = -1;
+        unlink(path.c_str());
+        return false;
+    }
+    socketPath = path;
+    return true;
+}
+
+/* serves requests until stop() is called
+ * @return false with a message on cerr if the server is not listening
+ **/
+bool AutocompleteServer::run() {
+    if (listenFd < 0) {
+        cerr << "The server is not listening" << endl;
+        return false;
+    }
+    for (unsigned int i = 0; i < numWorkers; i++) {
+        workers.push_back(thread(&AutocompleteServer::workerLoop, this));
+    }
+
+    epoll_event events[MAX_EVENTS];
+    while (!stopping) {
+        int ready = epoll_wait(epollFd, events, MAX_EVENTS, -1);
+        if (ready < 0 && errno != EINTR) {
+            cerr << "epoll_wait: " << strerror(errno) << endl;
+            break;
+        }
+
+        for (int i = 0; i < ready; i++) {
+            int fd = events[i].data.fd;
+            if (fd == wakeFd) {
+                uint64_t count;
+                while (read(wakeFd, &count, sizeof(count)) > 0) {
+                }
+                collectAnswers();
+            } else if (fd == listenFd) {
+                acceptConnections();
+            } else {
+                auto found = connectionOfFd.find(fd);
+                if (found == connectionOfFd.end()) {
+                    continue;
+                }
+                uint64_t id = found->second;
+                Connection& connection = connections[id];
+                if (events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) {
+                    readConnection(connection);
+                }
+                if (events[i].events & EPOLLOUT) {
+                    writeConnection(connection);
+                }
+                closeIfFinished(id);
+            }
+        }
+    }
+
+    // let the workers drain out
+    {
+        lock_guard<mutex> guard(jobLock);
+        stopping = true;
+    }
+    jobReady.notify_all();
+    for (unsigned int i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+    workers.clear();
+    return true;
+}
+
+/* makes run() return, safe to call from signal handlers */
+void AutocompleteServer::stop() {
+    stopping = true;
+    uint64_t one = 1;
+    ssize_t written = write(wakeFd, &one, sizeof(one));
+    (void)written;
+}
+
+/* splits a "<numCompletions> <prefix or pattern>" request line
+ * @return false if the line is not a request
+ */
+static bool parseRequest(const string& request, unsigned int& numCompletions,
+                         string& query) {
+    size_t space = request.find(' ');
+    if (space == string::npos || space == 0 ||
+        space + 1 == request.length()) {
+        return false;
+    }
+    numCompletions = 0;
+    for (size_t i = 0; i < space; i++) {
+        if (request[i] < '0' || request[i] > '9') {
+            return false;
+        }
+        numCompletions = numCompletions * 10 + (request[i] - '0');
+    }
+    query = request.substr(space + 1);
+    return true;
+}
+
+/* the response line of completions, most frequent first as autocomplete
+ * prints them, with a trailing tab if the answer is incomplete
+ */
+static string formatResponse(vector<string>& completions, bool incomplete) {
+    string response;
+    while (!completions.empty()) {
+        response += completions.back();
+        completions.pop_back();
+        if (!completions.empty()) {
+            response += '\t';
+        }
+    }
+    if (incomplete) {
+        response += '\t';
+    }
+    return response;
+}
+
+/* answers a single request line, without the newline, within a
+ * QueryBudget of maxVisits and timeLimit
+ **/
+string AutocompleteServer::answer(const DictionaryTrie& dict,
+                                  const string& request,
+                                  unsigned long long maxVisits,
+                                  chrono::nanoseconds timeLimit) {
+    unsigned int numCompletions;
+    string query;
+    if (!parseRequest(request, numCompletions, query)) {
+        return "";
+    }
+
+    vector<string> completions;
+    QueryBudget budget(maxVisits, timeLimit);
+    bool limited = maxVisits != 0 || timeLimit > chrono::nanoseconds::zero();
+    if (query.find('_') != string::npos) {
+        completions =
+            limited ? dict.predictUnderscores(query, numCompletions, budget)
+                    : dict.predictUnderscores(query, numCompletions);
+    } else {
+        completions =
+            limited ? dict.predictCompletions(query, numCompletions, budget)
+                    : dict.predictCompletions(query, numCompletions);
+    }
+    return formatResponse(completions, budget.exhausted);
+}
+
+/* answers a single request line, without the newline, from any
+ * dictionary engine, without limits
+ **/
+string AutocompleteServer::answer(const DictionaryEngine& dict,
+                                  const string& request) {
+    unsigned int numCompletions;
+    string query;
+    if (!parseRequest(request, numCompletions, query)) {
+        return "";
+    }
+    vector<string> completions =
+        query.find('_') != string::npos
+            ? dict.predictUnderscores(query, numCompletions)
+            : dict.predictCompletions(query, numCompletions);
+    return formatResponse(completions, false);
+}
+
+/**
+ * Destructor
+ * closes every connection and removes the socket file
+ */
+AutocompleteServer::~AutocompleteServer() {
+    for (auto& connection : connections) {
+        close(connection.second.fd);
+    }
+    if (listenFd >= 0) {
+        close(listenFd);
+        unlink(socketPath.c_str());
+    }
+    if (wakeFd >= 0) {
+        close(wakeFd);
+    }
+    if (epollFd >= 0) {
+        close(epollFd);
+    }
+}
+
+/**
+ * Accept Helper
+ * the listening socket is non blocking, accept until it runs dry
+ */
+void AutocompleteServer::acceptConnections() {
+    while (true) {
+        int fd = accept4(listenFd, nullptr, nullptr,
+                         SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd < 0) {
+            return;
+        }
+
+        epoll_event event;
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if (epoll_ctl(epollFd, EPOLL_CTL_ADD, fd, &event) < 0) {
+            cerr << "epoll_ctl: " << strerror(errno) << endl;
+            close(fd);
+            continue;
+        }
+
+        uint64_t id = nextConnection++;
+        connections[id].fd = fd;
+        connectionOfFd[fd] = id;
+    }
+}
+
+/**
+ * Read Helper
+ * every complete line becomes a job, numbered in arrival order
+ */
+void AutocompleteServer::readConnection(Connection& connection) {
+    char buffer[16 * 1024];
+    vector<Job> received;
+    uint64_t id = connectionOfFd[connection.fd];
+
+    while (!connection.readClosed) {
+        ssize_t bytes = read(connection.fd, buffer, sizeof(buffer));
+        if (bytes > 0) {
+            connection.input.append(buffer, bytes);
+        } else if (bytes < 0 && (errno == EAGAIN || errno == EINTR)) {
+            break;
+        } else {  // end of stream or a broken connection
+            connection.readClosed = true;
+        }
+
+        size_t start = 0;
+        size_t end;
+        while ((end = connection.input.find('\n', start)) != string::npos) {
+            string line = connection.input.substr(start, end - start);
+            if (!line.empty() && line.back() == '\r') {
+                line.pop_back();
+            }
+            received.push_back(Job{id, connection.nextRequest++, line, ""});
+            start = end + 1;
+        }
+        connection.input.erase(0, start);
+
+        if (connection.input.size() > MAX_REQUEST) {
+            connection.readClosed = true;
+            connection.input.clear();
+        }
+    }
+
+    if (connection.readClosed) {
+        watch(connection);
+    }
+
+    if (!received.empty()) {
+        {
+            lock_guard<mutex> guard(jobLock);
+            jobs.insert(jobs.end(), received.begin(), received.end());
+        }
+        jobReady.notify_all();
+    }
+}
+
+/**
+ * Write Helper
+ * waits for EPOLLOUT only while the socket is full
+ */
+void AutocompleteServer::writeConnection(Connection& connection) {
+    size_t written = 0;
+    while (written < connection.output.size()) {
+        ssize_t bytes =
+            send(connection.fd, connection.output.data() + written,
+                 connection.output.size() - written, MSG_NOSIGNAL);
+        if (bytes < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            if (errno != EAGAIN) {  // peer went away, drop what is left
+                written = connection.output.size();
+                connection.readClosed = true;
+            }
+            break;
+        }
+        written += bytes;
+    }
+    connection.output.erase(0, written);
+
+    bool writing = !connection.output.empty();
+    if (writing != connection.writing) {
+        connection.writing = writing;
+        watch(connection);
+    }
+}
+
+/**
+ * Watch Helper
+ * epoll reports EPOLLHUP and EPOLLERR whatever the events asked for, so
+ * a hung up connection waiting for nothing leaves the epoll set instead
+ * of waking every epoll_wait until its answers are ready
+ */
+void AutocompleteServer::watch(Connection& connection) {
+    epoll_event event;
+    event.events = (connection.readClosed ? 0 : (uint32_t)EPOLLIN) |
+                   (connection.writing ? (uint32_t)EPOLLOUT : 0);
+    event.data.fd = connection.fd;
+    if (event.events == 0) {
+        if (connection.watched) {
+            epoll_ctl(epollFd, EPOLL_CTL_DEL, connection.fd, nullptr);
+            connection.watched = false;
+        }
+        return;
+    }
+    int op = connection.watched ? EPOLL_CTL_MOD : EPOLL_CTL_ADD;
+    if (epoll_ctl(epollFd, op, connection.fd, &event) < 0) {
+        // cannot wait on it, drop the connection
+        cerr << "epoll_ctl: " << strerror(errno) << endl;
+        connection.readClosed = true;
+        connection.output.clear();
+        connection.writing = false;
+        return;
+    }
+    connection.watched = true;
+}
+
+/**
+ * Answer Helper
+ * answers may finish out of order, they wait in answered until
+ * every earlier request of their connection has been answered
+ */
+void AutocompleteServer::collectAnswers() {
+    vector<Job> finished;
+    {
+        lock_guard<mutex> guard(doneLock);
+        finished.swap(done);
+    }
+
+    vector<uint64_t> touched;
+    for (unsigned int i = 0; i < finished.size(); i++) {
+        auto found = connections.find(finished[i].connection);
+        if (found == connections.end()) {  // client already gone
+            continue;
+        }
+        Connection& connection = found->second;
+        connection.answered[finished[i].sequence] = finished[i].response;
+
+        auto next = connection.answered.find(connection.nextResponse);
+        while (next != connection.answered.end()) {
+            connection.output += next->second;
+            connection.output += '\n';
+            connection.answered.erase(next);
+            next = connection.answered.find(++connection.nextResponse);
+        }
+        touched.push_back(finished[i].connection);
+    }
+
+    for (unsigned int i = 0; i < touched.size(); i++) {
+        auto found = connections.find(touched[i]);
+        if (found != connections.end()) {
+            writeConnection(found->second);
+            closeIfFinished(touched[i]);
+        }
+    }
+}
+
+/**
+ * Close Helper
+ * a client that stopped sending still gets every answer it asked for
+ */
+void AutocompleteServer::closeIfFinished(uint64_t id) {
+    auto found = connections.find(id);
+    if (found == connections.end()) {
+        return;
+    }
+    Connection& connection = found->second;
+    if (!connection.readClosed ||
+        connection.nextResponse != connection.nextRequest ||
+        !connection.output.empty()) {
+        return;
+    }
+
+    if (connection.watched) {
+        epoll_ctl(epollFd, EPOLL_CTL_DEL, connection.fd, nullptr);
+    }
+    close(connection.fd);
+    connectionOfFd.erase(connection.fd);
+    connections.erase(found);
+}
+
+/**
+ * Worker Helper
+ * answers jobs in batches and wakes the event loop once per batch
+ */
+void AutocompleteServer::workerLoop() {
+    while (true) {
+        vector<Job> batch;
+        {
+            unique_lock<mutex> guard(jobLock);
+            jobReady.wait(guard,
+                          [this]() { return stopping || !jobs.empty(); });
+            if (jobs.empty()) {  // stopping with nothing left to do
+                return;
+            }
+            // leave work for the other workers when there is plenty
+            size_t take = max<size_t>(1, jobs.size() / numWorkers);
+            for (size_t i = 0; i < take; i++) {
+                batch.push_back(jobs.front());
+                jobs.pop_front();
+            }
+        }
+
+        for (unsigned int i = 0; i < batch.size(); i++) {
+            batch[i].response =
+                answer(dict, batch[i].request, maxVisits, timeLimit);
+        }
+
+        {
+            lock_guard<mutex> guard(doneLock);
+            done.insert(done.end(), batch.begin(), batch.end());
+        }
+        uint64_t one = 1;
+        ssize_t written = write(wakeFd, &one, sizeof(one));
+        (void)written;
+    }
+}
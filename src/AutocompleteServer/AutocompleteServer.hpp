@@ -0,0 +1,143 @@
+/**
+ * This hpp file defines the AutocompleteServer, which serves
+ * completions from one resident DictionaryTrie to many local
+ * clients over a Unix domain socket
+ *
+ * Protocol: every request is a line "<numCompletions> <prefix or
+ * pattern>", patterns containing an underscore are matched with
+ * predictUnderscores. Every request gets one response line with
+ * the completions, most frequent first, separated by tabs (words
+ * may contain spaces). A query that ran out of its budget gets the
+ * best completions it found and a trailing tab, marking the answer
+ * incomplete. Malformed requests get an empty line.
+ * Clients may pipeline requests, responses come back in request
+ * order on each connection.
+ */
+#ifndef AUTOCOMPLETE_SERVER_HPP
+#define AUTOCOMPLETE_SERVER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "DictionaryTrie.hpp"
+
+using namespace std;
+
+/**
+ * An epoll driven event loop that reads and writes every
+ * connection, and a pool of workers that run the queries.
+ */
+class AutocompleteServer {
+  private:
+    /* a request waiting for, or answered by, a worker */
+    struct Job {
+        uint64_t connection;
+        uint64_t sequence;  // position of the request on its connection
+        string request;
+        string response;
+    };
+
+    /* state of a client connection, owned by the event loop */
+    struct Connection {
+        int fd;
+        string input;   // bytes read but not yet a full line
+        string output;  // responses not yet written
+        uint64_t nextRequest = 0;
+        uint64_t nextResponse = 0;
+        map<uint64_t, string> answered;  // responses that arrived early
+        bool readClosed = false;
+        bool writing = false;  // waiting for EPOLLOUT
+        bool watched = true;   // in the epoll set
+    };
+
+    const DictionaryTrie& dict;
+    unsigned int numWorkers;
+    unsigned long long maxVisits;  // per query, 0 for no limit
+    chrono::nanoseconds timeLimit;  // per query, 0 for no limit
+    int listenFd;
+    int epollFd;
+    int wakeFd;  // eventfd the workers and stop() use to wake the loop
+    int setupError;  // errno if the epoll set could not be made
+    string socketPath;
+    atomic<bool> stopping;
+
+    unordered_map<uint64_t, Connection> connections;
+    unordered_map<int, uint64_t> connectionOfFd;
+    uint64_t nextConnection;
+
+    mutex jobLock;
+    condition_variable jobReady;
+    deque<Job> jobs;
+    mutex doneLock;
+    vector<Job> done;
+    vector<thread> workers;
+
+    /* accepts every pending connection */
+    void acceptConnections();
+    /* reads from a connection and queues its complete lines */
+    void readConnection(Connection& connection);
+    /* writes as much pending output as the socket takes */
+    void writeConnection(Connection& connection);
+    /* waits for the events a connection needs, none leaves the set */
+    void watch(Connection& connection);
+    /* moves worker answers to their connections, in request order */
+    void collectAnswers();
+    /* closes a connection once it has nothing left to send */
+    void closeIfFinished(uint64_t id);
+    /* worker thread body */
+    void workerLoop();
+
+  public:
+    /* Initializes a server answering from dict with numWorkers threads,
+     * every query visiting at most maxVisits nodes and running at most
+     * timeLimit, 0 for no limit
+     **/
+    AutocompleteServer(
+        const DictionaryTrie& dict, unsigned int numWorkers,
+        unsigned long long maxVisits = 0,
+        chrono::nanoseconds timeLimit = chrono::nanoseconds::zero());
+
+    // owns file descriptors and threads
+    AutocompleteServer(const AutocompleteServer&) = delete;
+    AutocompleteServer& operator=(const AutocompleteServer&) = delete;
+
+    /* binds and listens on a Unix socket, replacing a stale socket file
+     * @return true on success, false with a message on cerr otherwise
+     **/
+    bool listen(const string& path);
+
+    /* serves requests until stop() is called
+     * @return false with a message on cerr if the server is not listening
+     **/
+    bool run();
+
+    /* makes run() return, safe to call from signal handlers */
+    void stop();
+
+    /* answers a single request line, without the newline, within a
+     * QueryBudget of maxVisits and timeLimit
+     **/
+    static string answer(
+        const DictionaryTrie& dict, const string& request,
+        unsigned long long maxVisits = 0,
+        chrono::nanoseconds timeLimit = chrono::nanoseconds::zero());
+
+    /* answers a single request line, without the newline, from any
+     * dictionary engine, without limits
+     **/
+    static string answer(const DictionaryEngine& dict,
+                         const string& request);
+
+    /* Destructor, closes every connection and removes the socket file */
+    ~AutocompleteServer();
+};
+
+#endif  // AUTOCOMPLETE_SERVER_HPP
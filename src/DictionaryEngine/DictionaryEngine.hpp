@@ -0,0 +1,93 @@
+/**
+ * This hpp file defines the DictionaryEngine, the interface every
+ * dictionary structure answering autocomplete queries implements, and
+ * the wordComparator ranking the words they return
+ */
+#ifndef DICTIONARY_ENGINE_HPP
+#define DICTIONARY_ENGINE_HPP
+
+#include <queue>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/* comparator structure for comparing pairs
+ * This compares <string, int> pairs
+ * first the strings are compared in alphabetically
+ * If the strings are equal we compare the ints
+ * the smaller int is returned.
+ */
+struct wordComparator {
+    // operator takes in two pairs of <int, string>
+    bool operator()(const pair<int, string>& p1, const pair<int, string>& p2) {
+        // if the frequencies are equal sort by alphabetical order
+        if (p1.first == p2.first) {
+            return p1.second < p2.second;
+        }
+        // else sort from least to greatest frequency
+        else {
+            return p1.first > p2.first;
+        }
+    }
+};
+
+/* priority queue of <frequency, word> pairs ordered by wordComparator,
+ * the lowest ranked of the words kept so far sits on top
+ */
+typedef priority_queue<pair<int, string>, vector<pair<int, string>>,
+                       wordComparator>
+    WordPQ;
+
+/**
+ * A dictionary of words with frequencies, whatever structure holds
+ * them. Utils::loadDict fills any engine and the executables pick one
+ * by name with Utils::newEngine, so the structures can be compared on
+ * the same data and the same queries.
+ * Completions are returned lowest ranked first, as drained from a
+ * WordPQ, the order DictionaryTrie has always used.
+ */
+class DictionaryEngine {
+  public:
+    /* inserts a new word into the dictionary
+     * @param word, the word we want to insert
+     * @param freq, the number of times that word occurs
+     * @return true if inserted false if empty, frequency 0 or duplicate
+     **/
+    virtual bool insert(string word, unsigned int freq) = 0;
+
+    /* inserts <frequency, word> pairs as insert would one by one, the
+     * first of any duplicates is kept. Engines with a faster way to add
+     * many words at once override it
+     * @return the number of words inserted
+     **/
+    virtual size_t insertAll(const vector<pair<unsigned int, string>>& words) {
+        size_t inserted = 0;
+        for (size_t i = 0; i < words.size(); i++) {
+            inserted += insert(words[i].second, words[i].first);
+        }
+        return inserted;
+    }
+
+    /* finds a word in the dictionary
+     * @return true if found false otherwise
+     **/
+    virtual bool find(string word) const = 0;
+
+    /* the numCompletions most frequent words starting with prefix,
+     * none for an empty prefix
+     **/
+    virtual vector<string> predictCompletions(
+        string prefix, unsigned int numCompletions) const = 0;
+
+    /* the numCompletions most frequent words matching pattern, where
+     * '_' matches any one character, none for an empty pattern
+     **/
+    virtual vector<string> predictUnderscores(
+        string pattern, unsigned int numCompletions) const = 0;
+
+    virtual ~DictionaryEngine() {}
+};
+
+#endif  // DICTIONARY_ENGINE_HPP
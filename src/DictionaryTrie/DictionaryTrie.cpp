@@ -9,10 +9,14 @@
  */
 #include "DictionaryTrie.hpp"
 #include <string.h>
+#include "InfixIndex.hpp"
+#include "WordIndex.hpp"
 #include <algorithm>
+#include <atomic>
 #include <iostream>
 #include <iterator>
 #include <stack>
+#include <thread>
 #include <utility>
 #include <vector>
 
@@ -27,9 +31,13 @@ DictionaryTrie::DictionaryTrieNode::DictionaryTrieNode(char thisLabel)
       right(0),
       parent(0),
       child(0),
-      isWordNode(false) {}
+      isWordNode(false),
+      Frequency(0),
+      maxFrequency(0),
+      subtrieWords(0) {}
 
-DictionaryTrie::DictionaryTrie() : root(0) {}
+DictionaryTrie::DictionaryTrie()
+    : root(0), wordIndex(nullptr), infixIndex(nullptr), pendingSelections(0) {}
 
 /* inserts a new word into the dictionary
  * @param word, the word we want to insert
@@ -59,16 +67,33 @@ bool DictionaryTrie::insert(string word, unsigned int freq) {
         curr->isWordNode = true;
         curr->Frequency = freq;
 
+        // every node on the first word's path has it in its subtrie
+        for (curr = root; curr != nullptr; curr = curr->child) {
+            curr->maxFrequency = freq;
+            curr->subtrieWords = 1;
+        }
+
+        if (wordIndex != nullptr) {
+            wordIndex->insert(word, freq);
+        }
+        if (infixIndex != nullptr) {
+            infixIndex->insert(word, freq);
+        }
         return true;
     }
 
     // if word exists, return false
-    if (find(word)) {
+    bool exists = wordIndex != nullptr ? !wordIndex->insert(word, freq)
+                                       : find(word);
+    if (exists) {
         return false;
     }
 
     // insert helper function that builds the subtree
     root = insertNode(word, 0, freq, root);
+    if (infixIndex != nullptr) {
+        infixIndex->insert(word, freq);
+    }
 
     return true;
 }
@@ -78,6 +103,10 @@ bool DictionaryTrie::insert(string word, unsigned int freq) {
  * @return true if found false otherwise
  **/
 bool DictionaryTrie::find(string word) const {
+    if (wordIndex != nullptr) {  // exact lookups go to the index if built
+        return wordIndex->contains(word);
+    }
+
     // creates curr node and sets it to root
     DictionaryTrieNode* curr = root;
 
@@ -134,37 +163,208 @@ bool DictionaryTrie::find(string word) const {
     }
 }
 
+/* finds many words, interleaving the lookups so the cache misses
+ * of up to groupSize of them overlap instead of stalling one by one
+ * @param words, the words we want to find
+ * @param groupSize, the number of lookups in flight at once
+ * @return found[i] is true if words[i] is in the dictionary
+ **/
+vector<bool> DictionaryTrie::findMany(const vector<string>& words,
+                                      unsigned int groupSize) const {
+    vector<DictionaryTrieNode*> nodes;
+    findNodeMany(words, nodes, groupSize);
+
+    vector<bool> found(words.size());
+    for (unsigned int i = 0; i < nodes.size(); i++) {
+        found[i] = nodes[i] != nullptr && nodes[i]->isWordNode;
+    }
+    return found;
+}
+
+/* frequency of a word in the dictionary
+ * @param word we want the frequency of
+ * @return the frequency, 0 if the word is not in the dictionary
+ **/
+unsigned int DictionaryTrie::frequency(string word) const {
+    if (wordIndex != nullptr) {
+        return wordIndex->frequency(word);
+    }
+    if (word.empty()) {
+        return 0;
+    }
+    DictionaryTrieNode* node = findNode(word);
+    return node != nullptr && node->isWordNode ? node->Frequency.load() : 0;
+}
+
+/* builds a hash index of every word next to the trie, kept in
+ * sync by insert. find and frequency then answer from the index
+ * in expected O(1), with a Bloom filter turning most absent words
+ * away before the table is probed. Prefix and pattern queries
+ * still walk the trie
+ **/
+void DictionaryTrie::buildIndex() {
+    vector<pair<unsigned int, string>> words;
+    collectWords(words);
+
+    delete wordIndex;
+    wordIndex = new WordIndex(words.size());
+    for (unsigned int i = 0; i < words.size(); i++) {
+        wordIndex->insert(words[i].second, words[i].first);
+    }
+}
+
+/* builds a suffix array index of every word next to the trie, kept
+ * in sync by insert, so predictInfix answers in time proportional to
+ * the fragment length and numCompletions instead of scanning every
+ * word. recordSelection does not reach it, repairFrequencies copies
+ * the trie's frequencies into it, so it ranks words as the trie does
+ * after every repair
+ * @param tokenStartsOnly, match fragments only at the start of a
+ * space separated token, for a much smaller index
+ **/
+void DictionaryTrie::buildInfixIndex(bool tokenStartsOnly) {
+    vector<pair<unsigned int, string>> words;
+    collectWords(words);
+
+    delete infixIndex;
+    infixIndex = new InfixIndex(words, tokenStartsOnly);
+}
+
+/* learns from a selected completion: adds count to the frequency of
+ * word with a relaxed atomic increment and nothing else, so it can
+ * run alongside queries and other selections without a lock. The
+ * maxFrequency of the word's ancestors is repaired later, in a
+ * batch, by repairFrequencies
+ * @param word, the word that was selected
+ * @param count, the number of selections
+ * @return false if the word is not in the dictionary
+ **/
+bool DictionaryTrie::recordSelection(string word, unsigned int count) {
+    DictionaryTrieNode* node = word.empty() ? nullptr : findNode(word);
+    if (node == nullptr || !node->isWordNode) {
+        return false;
+    }
+    node->Frequency.fetch_add(count, memory_order_relaxed);
+    if (wordIndex != nullptr) {
+        wordIndex->addFrequency(word, count);
+    }
+    pendingSelections.fetch_add(1, memory_order_relaxed);
+    return true;
+}
+
+/* brings every maxFrequency up to date after recordSelection, first
+ * scaling every frequency by decay (rounded down, never below 1)
+ * when decay is below 1, and brings the infix index up to date.
+ * Runs alongside queries and recordSelection but not alongside insert
+ * @param decay, the factor frequencies are scaled by
+ * @return the number of selections recorded since the last repair
+ **/
+unsigned long long DictionaryTrie::repairFrequencies(double decay) {
+    unsigned long long selections = pendingSelections.exchange(0);
+    if (selections == 0 && decay >= 1.0) {
+        return 0;
+    }
+    string prefix;
+    repairHelper(root, min(decay, 1.0), prefix);
+
+    if (infixIndex != nullptr) {  // no word to id map, so look them up
+        for (unsigned int id = 0; id < infixIndex->size(); id++) {
+            DictionaryTrieNode* node = findNode(infixIndex->word(id));
+            infixIndex->setFrequency(
+                id, node->Frequency.load(memory_order_relaxed));
+        }
+        infixIndex->reorder();
+    }
+    return selections;
+}
+
 /* predicts words given a prefix based on words with
  * the highest frequencies
  * @param prefix, the prefix we want to complete
  * @param numCompletions, the number of suggestions we want
  * @return a vector of suggested completions
  **/
-vector<string> DictionaryTrie::predictCompletions(string prefix,
-                                                  unsigned int numCompletions) {
+vector<string> DictionaryTrie::predictCompletions(
+    string prefix, unsigned int numCompletions) const {
     vector<string> completionSet;  // vector to store all predictions
+    WordPQ thisPQ;                 // local so concurrent queries are safe
 
-    if (numCompletions <= 0) {  // Edge case if numCompletions is <= 0
-        return completionSet;
+    collectCompletions(prefix, numCompletions, thisPQ);
+
+    while (thisPQ.size() != 0) {  // push into vector
+        completionSet.push_back(thisPQ.top().second);
+        thisPQ.pop();  // pop from Priority Queue
     }
-    // find node that contains prefix
-    DictionaryTrieNode* endOfPrefix = findNode(prefix);
+    return completionSet;
+}
 
-    if (endOfPrefix == nullptr) {  // Returns if node is null
-        return completionSet;
+/* number of words starting with prefix, in O(prefix length) from the
+ * word counts every node keeps of its subtrie
+ * @param prefix, the prefix we want to count, "" counts every word
+ * @return the number of words in the dictionary starting with prefix
+ **/
+unsigned int DictionaryTrie::countPrefix(string prefix) const {
+    if (prefix.empty()) {
+        return wordsIn(root);
     }
+    DictionaryTrieNode* endOfPrefix = findNode(prefix);
+    if (endOfPrefix == nullptr) {
+        return 0;
+    }
+    // endOfPrefix's own count also holds its left and right siblings
+    return endOfPrefix->isWordNode + wordsIn(endOfPrefix->child);
+}
 
-    // if node is a word, push to Priority Queue
+/* lazily lists every completion of a prefix, best first. Frequency
+ * ties aside, the first numCompletions of them are the words
+ * predictCompletions returns, which lists them the other way round
+ * @param prefix, the prefix we want to complete, "" lists every word
+ * @return an iterator, valid as long as the trie
+ **/
+DictionaryTrie::CompletionIterator DictionaryTrie::completions(
+    string prefix) const {
+    CompletionIterator iterator;
+    if (prefix.empty()) {
+        iterator.pushSubtrie(root, prefix);
+        return iterator;
+    }
+    DictionaryTrieNode* endOfPrefix = findNode(prefix);
+    if (endOfPrefix == nullptr) {
+        return iterator;
+    }
     if (endOfPrefix->isWordNode) {
-        thisPQ.push(pair<int, string>(endOfPrefix->Frequency, prefix));
+        iterator.frontier.push(
+            CompletionIterator::Entry{endOfPrefix->Frequency, nullptr, prefix});
     }
+    iterator.pushSubtrie(endOfPrefix->child, prefix);
+    return iterator;
+}
 
-    // Depth First Search
-    depthFirst(prefix, endOfPrefix->child, numCompletions);
+/* predictCompletions within a budget. The words are looked at best
+ * first, so the ones found before the budget runs out are the best
+ * ones, only fewer of them
+ * @param budget, the limits, exhausted is set if they were hit
+ * @return a vector of suggested completions, in the same order
+ **/
+vector<string> DictionaryTrie::predictCompletions(
+    string prefix, unsigned int numCompletions, QueryBudget& budget) const {
+    vector<string> completionSet;
+    if (numCompletions <= 0 || prefix == "") {
+        return completionSet;
+    }
 
-    while (thisPQ.size() != 0) {  // push into vector
+    // best first, so every word taken belongs in the answer
+    WordPQ thisPQ;
+    CompletionIterator iterator = completions(prefix);
+    while (thisPQ.size() < numCompletions && iterator.advance(&budget)) {
+        thisPQ.push(pair<int, string>(iterator.frontier.top().bound,
+                                      iterator.frontier.top().text));
+        iterator.frontier.pop();
+    }
+
+    while (!thisPQ.empty()) {
         completionSet.push_back(thisPQ.top().second);
-        thisPQ.pop();  // pop from Priority Queue
+        thisPQ.pop();
     }
     return completionSet;
 }
@@ -175,14 +375,12 @@ vector<string> DictionaryTrie::predictCompletions(string prefix,
  * @return a vector of suggested completions
  **/
 std::vector<string> DictionaryTrie::predictUnderscores(
-    string pattern, unsigned int numCompletions) {
+    string pattern, unsigned int numCompletions) const {
     vector<string> completionSet;  // vector to store string predictions
-    // Edge case (numCompletions <= 0 or pattern is empty string)
-    if (numCompletions <= 0 || pattern == "") {
-        return completionSet;  // return empty list
-    }
-    // helper method to recursively find the underscore patterns
-    predictUnderscoresHelper(pattern, "", 0, root, numCompletions);
+    WordPQ underscorePQ;           // local so concurrent queries are safe
+
+    collectUnderscores(pattern, numCompletions, underscorePQ);
+
     // add priority queue's elements into vector in required order
     while (!underscorePQ.empty()) {
         completionSet.push_back(underscorePQ.top().second);
@@ -192,12 +390,336 @@ std::vector<string> DictionaryTrie::predictUnderscores(
     return completionSet;
 }
 
+/* predictUnderscores within a budget, returning the best matches
+ * found before it ran out
+ * @param budget, the limits, exhausted is set if they were hit
+ * @return a vector of suggested completions, in the same order
+ **/
+vector<string> DictionaryTrie::predictUnderscores(
+    string pattern, unsigned int numCompletions, QueryBudget& budget) const {
+    vector<string> completionSet;
+    WordPQ underscorePQ;
+    if (numCompletions > 0 && pattern != "") {
+        predictUnderscoresHelper(pattern, "", 0, root, numCompletions,
+                                 underscorePQ, &budget);
+    }
+
+    while (!underscorePQ.empty()) {
+        completionSet.push_back(underscorePQ.top().second);
+        underscorePQ.pop();
+    }
+    return completionSet;
+}
+
+/* predicts words containing a fragment anywhere, not only at the
+ * start, based on words with the highest frequencies. Scans every
+ * word unless buildInfixIndex was called
+ * @param fragment, the text the words must contain
+ * @param numCompletions, the number of suggestions we want
+ * @return a vector of suggested completions
+ **/
+vector<string> DictionaryTrie::predictInfix(
+    string fragment, unsigned int numCompletions) const {
+    vector<string> completionSet;
+    WordPQ infixPQ;  // local so concurrent queries are safe
+
+    collectInfix(fragment, numCompletions, infixPQ);
+
+    while (!infixPQ.empty()) {
+        completionSet.push_back(infixPQ.top().second);
+        infixPQ.pop();
+    }
+    return completionSet;
+}
+
+/* predictUnderscores for many patterns in one walk of the trie: the
+ * patterns are compiled into a trie of their own, so patterns that
+ * start alike share their matching, and every dictionary node is
+ * visited at most once for all of them
+ * @param patterns, the patterns we want to complete
+ * @param numCompletions, the number of suggestions we want for each
+ * @return the predictUnderscores answer of every pattern, in order
+ **/
+vector<vector<string>> DictionaryTrie::predictUnderscoresMany(
+    const vector<string>& patterns, unsigned int numCompletions) const {
+    // node 0 is the root, before the first position
+    vector<PatternNode> patternTrie(1);
+    for (unsigned int i = 0; i < patterns.size(); i++) {
+        if (patterns[i].empty()) {
+            continue;
+        }
+        unsigned int node = 0;
+        for (char c : patterns[i]) {
+            unsigned int next = 0;
+            for (auto& child : patternTrie[node].children) {
+                if (child.first == c) {
+                    next = child.second;
+                }
+            }
+            if (next == 0) {
+                next = patternTrie.size();
+                patternTrie[node].children.push_back(
+                    pair<char, unsigned int>(c, next));
+                if (c == '_') {
+                    patternTrie[node].wildcard = true;
+                } else {
+                    patternTrie[node].minLetter =
+                        min(patternTrie[node].minLetter, c);
+                    patternTrie[node].maxLetter =
+                        max(patternTrie[node].maxLetter, c);
+                }
+                patternTrie.push_back(PatternNode());
+            }
+            node = next;
+        }
+        patternTrie[node].patterns.push_back(i);
+    }
+
+    vector<WordPQ> completions(patterns.size());
+    if (numCompletions > 0 && patternTrie.size() > 1) {
+        string prefix;
+        underscoresManyHelper(root, patternTrie, vector<unsigned int>(1, 0),
+                              patternTrie[0].wildcard,
+                              patternTrie[0].minLetter,
+                              patternTrie[0].maxLetter, prefix,
+                              numCompletions, completions);
+    }
+
+    vector<vector<string>> completionSets(patterns.size());
+    for (unsigned int i = 0; i < patterns.size(); i++) {
+        while (!completions[i].empty()) {
+            completionSets[i].push_back(completions[i].top().second);
+            completions[i].pop();
+        }
+    }
+    return completionSets;
+}
+
+/* adds the best completions of a prefix to a priority queue
+ * @param prefix, the prefix we want to complete
+ * @param numCompletions, the most words completions may hold
+ * @param completions, queue of <frequency, word> pairs to add to
+ **/
+void DictionaryTrie::collectCompletions(string prefix,
+                                        unsigned int numCompletions,
+                                        WordPQ& completions) const {
+    // Edge case (numCompletions <= 0 or prefix is empty string)
+    if (numCompletions <= 0 || prefix == "") {
+        return;
+    }
+    // find node that contains prefix
+    DictionaryTrieNode* endOfPrefix = findNode(prefix);
+
+    if (endOfPrefix == nullptr) {  // Returns if node is null
+        return;
+    }
+
+    // if node is a word, push to Priority Queue
+    if (endOfPrefix->isWordNode) {
+        if (completions.size() < numCompletions) {
+            completions.push(
+                pair<int, string>(endOfPrefix->Frequency, prefix));
+        } else if (completions.top().first <
+                   (int)endOfPrefix->Frequency) {
+            completions.pop();
+            completions.push(
+                pair<int, string>(endOfPrefix->Frequency, prefix));
+        }
+    }
+
+    // Depth First Search
+    depthFirst(prefix, endOfPrefix->child, numCompletions, completions);
+}
+
+/* adds the best matches of an underscore pattern to a priority queue
+ * @param pattern, the pattern we want to complete
+ * @param numCompletions, the most words completions may hold
+ * @param completions, queue of <frequency, word> pairs to add to
+ **/
+void DictionaryTrie::collectUnderscores(string pattern,
+                                        unsigned int numCompletions,
+                                        WordPQ& completions) const {
+    // Edge case (numCompletions <= 0 or pattern is empty string)
+    if (numCompletions <= 0 || pattern == "") {
+        return;
+    }
+    // helper method to recursively find the underscore patterns
+    predictUnderscoresHelper(pattern, "", 0, root, numCompletions,
+                             completions);
+}
+
+/* adds the best words containing a fragment to a priority queue
+ * @param fragment, the text the words must contain
+ * @param numCompletions, the most words completions may hold
+ * @param completions, queue of <frequency, word> pairs to add to
+ **/
+void DictionaryTrie::collectInfix(string fragment,
+                                  unsigned int numCompletions,
+                                  WordPQ& completions) const {
+    if (numCompletions <= 0 || fragment == "") {
+        return;
+    }
+
+    vector<pair<unsigned int, string>> matches;
+    if (infixIndex != nullptr) {
+        vector<unsigned int> ids =
+            infixIndex->search(fragment, numCompletions);
+        for (unsigned int i = 0; i < ids.size(); i++) {
+            matches.push_back(pair<unsigned int, string>(
+                infixIndex->frequency(ids[i]), infixIndex->word(ids[i])));
+        }
+    } else {  // no index, look at every word
+        vector<pair<unsigned int, string>> words;
+        collectWords(words);
+        for (unsigned int i = 0; i < words.size(); i++) {
+            if (words[i].second.find(fragment) != string::npos) {
+                matches.push_back(words[i]);
+            }
+        }
+    }
+
+    for (unsigned int i = 0; i < matches.size(); i++) {
+        if (completions.size() < numCompletions) {
+            completions.push(
+                pair<int, string>(matches[i].first, matches[i].second));
+        } else if (completions.top().first < (int)matches[i].first) {
+            completions.pop();
+            completions.push(
+                pair<int, string>(matches[i].first, matches[i].second));
+        }
+    }
+}
+
+/* builds the trie from words grouped by first letter, each group
+ * becomes a subtrie on one of numThreads threads and the subtries
+ * are then hung off the root level in the order of the groups
+ * @param groups, <frequency, word> pairs sharing a first letter,
+ * ordered by the first appearance of that letter
+ * @param numThreads, the number of threads building subtries
+ **/
+void DictionaryTrie::buildParallel(
+    const vector<vector<pair<unsigned int, string>>>& groups,
+    unsigned int numThreads) {
+    // subtries can only be stitched onto an empty root level
+    if (root != nullptr) {
+        for (unsigned int i = 0; i < groups.size(); i++) {
+            for (unsigned int j = 0; j < groups[i].size(); j++) {
+                insert(groups[i][j].second, groups[i][j].first);
+            }
+        }
+        return;
+    }
+
+    // threads take the next unbuilt group, so one big letter does not
+    // hold up the others
+    vector<DictionaryTrie*> subtries(groups.size());
+    atomic<unsigned int> nextGroup(0);
+    auto buildGroups = [&]() {
+        unsigned int i;
+        while ((i = nextGroup++) < groups.size()) {
+            subtries[i] = new DictionaryTrie();
+            for (unsigned int j = 0; j < groups[i].size(); j++) {
+                subtries[i]->insert(groups[i][j].second, groups[i][j].first);
+            }
+        }
+    };
+    vector<thread> workers;
+    for (unsigned int i = 1; i < numThreads && i < groups.size(); i++) {
+        workers.push_back(thread(buildGroups));
+    }
+    buildGroups();
+    for (unsigned int i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+
+    // every word of a group shares its first letter, so each subtrie
+    // root has no left or right subtree of its own. Linking the roots in
+    // group order gives the root level sequential loading would build
+    for (unsigned int i = 0; i < subtries.size(); i++) {
+        DictionaryTrieNode* subtrie = subtries[i]->root;
+        subtries[i]->root = nullptr;
+        delete subtries[i];
+        if (subtrie == nullptr) {
+            continue;
+        }
+
+        DictionaryTrieNode** link = &root;
+        while (*link != nullptr) {
+            if ((*link)->maxFrequency < subtrie->maxFrequency) {
+                (*link)->maxFrequency = subtrie->maxFrequency.load();
+            }
+            (*link)->subtrieWords += subtrie->subtrieWords;
+            if (subtrie->nodeLabel < (*link)->nodeLabel) {
+                link = &(*link)->left;
+            } else {
+                link = &(*link)->right;
+            }
+        }
+        *link = subtrie;
+    }
+
+    // the subtries kept the first of any duplicates, so does the index
+    if (wordIndex != nullptr) {
+        for (unsigned int i = 0; i < groups.size(); i++) {
+            for (unsigned int j = 0; j < groups[i].size(); j++) {
+                wordIndex->insert(groups[i][j].second, groups[i][j].first);
+            }
+        }
+    }
+    if (infixIndex != nullptr) {
+        buildInfixIndex(infixIndex->indexesTokenStartsOnly());
+    }
+}
+
+/* lists every word in the dictionary
+ * @param words, receives the <frequency, word> pairs in
+ * alphabetical order
+ **/
+void DictionaryTrie::collectWords(
+    vector<pair<unsigned int, string>>& words) const {
+    string prefix;
+    collectWordsHelper(root, prefix, words);
+}
+
+/* measures the memory footprint and shape of the trie
+ * @return node and word counts, bytes by category, search depths,
+ * per level imbalance and the fan-out distribution
+ **/
+TrieStats DictionaryTrie::stats() const {
+    TrieStats stats;
+    unsigned int rootSiblings = 0;
+
+    collectStats(root, 0, 1, stats, rootSiblings);
+
+    stats.objectBytes = sizeof(DictionaryTrie);
+    stats.nodeBytes = stats.nodeCount * sizeof(DictionaryTrieNode);
+    stats.pointerBytes = stats.nodeCount * 4 * sizeof(DictionaryTrieNode*);
+    stats.labelBytes = stats.nodeCount * (sizeof(char) + sizeof(bool));
+    stats.frequencyBytes = stats.nodeCount * 2 * sizeof(unsigned int);
+    stats.countBytes = stats.nodeCount * sizeof(unsigned int);
+    stats.paddingBytes = stats.nodeBytes - stats.pointerBytes -
+                         stats.labelBytes - stats.frequencyBytes -
+                         stats.countBytes;
+    stats.indexBytes = wordIndex == nullptr ? 0 : wordIndex->sizeInBytes();
+    stats.infixBytes = infixIndex == nullptr ? 0 : infixIndex->sizeInBytes();
+    return stats;
+}
+
 /**
  * Destructor
  * deletes all nodes of Dictionary Trie
  * Avoids Memory Leaks
  */
-DictionaryTrie::~DictionaryTrie() { deleteAll(root); }
+DictionaryTrie::~DictionaryTrie() {
+    deleteAll(root);
+    delete wordIndex;
+    delete infixIndex;
+}
+
+/* number of words in the subtrie of node, 0 for nullptr */
+unsigned int DictionaryTrie::wordsIn(const DictionaryTrieNode* node) {
+    return node == nullptr ? 0 : node->subtrieWords;
+}
 
 /**
  * Insert Node Helper Method
@@ -211,12 +733,7 @@ DictionaryTrie::DictionaryTrieNode* DictionaryTrie::insertNode(
             curr->isWordNode = true;
             /* MAX FREQ UPDATE */
             curr->maxFrequency = Freq;
-            if (curr->left->Frequency > curr->maxFrequency) {
-                curr->maxFrequency = curr->left->Frequency;
-            }
-            if (curr->right->Frequency > curr->maxFrequency) {
-                curr->maxFrequency = curr->right->Frequency;
-            }
+            curr->subtrieWords = 1;
             return curr;
         } else {
             curr = new DictionaryTrieNode(word[index]);
@@ -229,17 +746,20 @@ DictionaryTrie::DictionaryTrieNode* DictionaryTrie::insertNode(
             curr->isWordNode = true;
             curr->Frequency = Freq;
             /* MAX FREQ UPDATE */
-            curr->maxFrequency = Freq;
-            if (curr->left->Frequency > curr->maxFrequency) {
-                curr->maxFrequency = curr->left->Frequency;
-            }
-            if (curr->right->Frequency > curr->maxFrequency) {
-                curr->maxFrequency = curr->right->Frequency;
+            if (curr->maxFrequency < (unsigned int)Freq) {
+                curr->maxFrequency = Freq;
             }
+            curr->subtrieWords++;
             return curr;
         }
     }
 
+    // the new word lands somewhere in curr's subtrie
+    if (curr->maxFrequency < (unsigned int)Freq) {
+        curr->maxFrequency = Freq;
+    }
+    curr->subtrieWords++;
+
     if (word[index] < curr->nodeLabel) {  // recurse left
         curr->left = insertNode(word, index, Freq, curr->left);
     }
@@ -258,7 +778,8 @@ DictionaryTrie::DictionaryTrieNode* DictionaryTrie::insertNode(
 /**
  * findNode: Helper Method for Find
  */
-DictionaryTrie::DictionaryTrieNode* DictionaryTrie::findNode(string prefix) {
+DictionaryTrie::DictionaryTrieNode* DictionaryTrie::findNode(
+    string prefix) const {
     DictionaryTrieNode* curr = root;
 
     string::iterator Itr = prefix.begin();  // iterate through the string
@@ -307,16 +828,130 @@ DictionaryTrie::DictionaryTrieNode* DictionaryTrie::findNode(string prefix) {
     return nullptr;
 }
 
+/**
+ * findNodeMany: Helper Method for findMany
+ * Keeps a group of lookups and advances each by one node in turn,
+ * prefetching the node it moves to. By the time the lookup comes
+ * round again that node is usually in cache, so the misses of the
+ * whole group are waited for together.
+ */
+void DictionaryTrie::findNodeMany(const vector<string>& prefixes,
+                                  vector<DictionaryTrieNode*>& nodes,
+                                  unsigned int groupSize) const {
+    nodes.assign(prefixes.size(), nullptr);
+    if (root == nullptr) {  // edge case null root
+        return;
+    }
+
+    // a lookup in flight: which prefix, its next character, its node
+    struct Lookup {
+        size_t prefix;
+        size_t index;
+        DictionaryTrieNode* curr;
+    };
+    vector<Lookup> group;
+    size_t next = 0;
+
+    // starts the next non empty prefix in slot, false if none is left
+    auto start = [&](Lookup& slot) {
+        while (next < prefixes.size() && prefixes[next].empty()) {
+            next++;
+        }
+        if (next == prefixes.size()) {
+            return false;
+        }
+        slot = Lookup{next++, 0, root};
+        return true;
+    };
+
+    Lookup slot;
+    while (group.size() < max(1u, groupSize) && start(slot)) {
+        group.push_back(slot);
+    }
+
+    while (!group.empty()) {
+        for (size_t i = 0; i < group.size();) {
+            Lookup& lookup = group[i];
+            const string& prefix = prefixes[lookup.prefix];
+            char c = prefix[lookup.index];
+            DictionaryTrieNode* curr = lookup.curr;
+
+            if (c < curr->nodeLabel) {  // Iterate left
+                curr = curr->left;
+            } else if (c > curr->nodeLabel) {  // Iterate right
+                curr = curr->right;
+            } else if (lookup.index + 1 == prefix.length()) {  // found
+                nodes[lookup.prefix] = curr;
+                curr = nullptr;
+            } else {  // iterate to the child
+                curr = curr->child;
+                lookup.index++;
+            }
+
+            if (curr != nullptr) {
+                __builtin_prefetch(curr);
+                lookup.curr = curr;
+                i++;
+            } else if (!start(lookup)) {  // finished, nothing to refill
+                lookup = group.back();
+                group.pop_back();
+            }
+        }
+    }
+}
+
+/**
+ * Repair Helper
+ * post order, so every maxFrequency is computed from finished subtries.
+ * The index is moved by the same amount as the trie while the words are
+ * at hand
+ */
+unsigned int DictionaryTrie::repairHelper(DictionaryTrieNode* curr,
+                                          double decay, string& prefix) {
+    if (curr == nullptr) {
+        return 0;
+    }
+    unsigned int maxFreq = max(repairHelper(curr->left, decay, prefix),
+                               repairHelper(curr->right, decay, prefix));
+
+    prefix.push_back(curr->nodeLabel);
+    if (curr->isWordNode) {
+        unsigned int freq = curr->Frequency.load(memory_order_relaxed);
+        // compare and swap, so a selection landing meanwhile is not lost.
+        // Rounded down, as rounding to nearest would never move a small
+        // frequency with decay close to 1
+        while (decay < 1.0) {
+            unsigned int decayed = max(1u, (unsigned int)(freq * decay));
+            if (curr->Frequency.compare_exchange_weak(
+                    freq, decayed, memory_order_relaxed)) {
+                // the same change, not the new value, so selections the
+                // index has not seen yet still land on top of it
+                if (wordIndex != nullptr) {
+                    wordIndex->addFrequency(prefix, decayed - freq);
+                }
+                freq = decayed;
+                break;
+            }
+        }
+        maxFreq = max(maxFreq, freq);
+    }
+    maxFreq = max(maxFreq, repairHelper(curr->child, decay, prefix));
+    prefix.pop_back();
+
+    curr->maxFrequency.store(maxFreq, memory_order_relaxed);
+    return maxFreq;
+}
+
 /**
  * DFS : Helper method to optimize predictCompletions
  */
 void DictionaryTrie::depthFirst(string prefix, DictionaryTrieNode* curr,
-                                int numCompletions) {
+                                int numCompletions, WordPQ& thisPQ) const {
     if (curr) {  // if curr exists
 
-        depthFirst(prefix, curr->left, numCompletions);  // recurse left
+        depthFirst(prefix, curr->left, numCompletions, thisPQ);  // recurse left
 
-        depthFirst(prefix, curr->right, numCompletions);  // recurse right
+        depthFirst(prefix, curr->right, numCompletions, thisPQ);  // recurse right
 
         prefix.push_back(curr->nodeLabel);
 
@@ -331,7 +966,7 @@ void DictionaryTrie::depthFirst(string prefix, DictionaryTrieNode* curr,
             }
         }
 
-        depthFirst(prefix, curr->child, numCompletions);  // recurse child
+        depthFirst(prefix, curr->child, numCompletions, thisPQ);  // recurse child
     }
 }
 
@@ -342,7 +977,9 @@ void DictionaryTrie::depthFirst(string prefix, DictionaryTrieNode* curr,
 void DictionaryTrie::predictUnderscoresHelper(string pattern,
                                               string currentProgress, int index,
                                               DictionaryTrieNode* curr,
-                                              int numCompletions) {
+                                              int numCompletions,
+                                              WordPQ& underscorePQ,
+                                              QueryBudget* budget) const {
     // Edge Case (Index Out of Bounds)
     if (index >= pattern.length()) {
         return;
@@ -353,18 +990,25 @@ void DictionaryTrie::predictUnderscoresHelper(string pattern,
         return;
     }
 
+    // Out of budget, keep what was found so far
+    if (budget != nullptr && !budget->spend()) {
+        return;
+    }
+
     // If the current index of the string is an underscore
     if (pattern[index] == '_') {
         // Recursively retrieves all the underscores on the left subtrie
         if (curr->left) {
             predictUnderscoresHelper(pattern, currentProgress, index,
-                                     curr->left, numCompletions);
+                                     curr->left, numCompletions,
+                                     underscorePQ, budget);
         }
 
         // recursively retrieves all the underscores on the right subtrie
         if (curr->right) {
             predictUnderscoresHelper(pattern, currentProgress, index,
-                                     curr->right, numCompletions);
+                                     curr->right, numCompletions,
+                                     underscorePQ, budget);
         }
 
         // push back to update current pattern in progress by adding curr's char
@@ -389,7 +1033,8 @@ void DictionaryTrie::predictUnderscoresHelper(string pattern,
         // if it is not a word node recurse on child
         if (curr->child) {
             predictUnderscoresHelper(pattern, currentProgress, index + 1,
-                                     curr->child, numCompletions);
+                                     curr->child, numCompletions,
+                                     underscorePQ, budget);
         }
     }
     // if not an underscore
@@ -417,7 +1062,8 @@ void DictionaryTrie::predictUnderscoresHelper(string pattern,
                 return;
             } else {  // recurse child
                 predictUnderscoresHelper(pattern, currentProgress, index + 1,
-                                         curr->child, numCompletions);
+                                         curr->child, numCompletions,
+                                         underscorePQ, budget);
             }
         }
         // if the chars are not equal
@@ -425,17 +1071,90 @@ void DictionaryTrie::predictUnderscoresHelper(string pattern,
             // if less than current node's char then recurse on left
             if (pattern[index] < curr->nodeLabel) {
                 predictUnderscoresHelper(pattern, currentProgress, index,
-                                         curr->left, numCompletions);
+                                         curr->left, numCompletions,
+                                         underscorePQ, budget);
             }
             // if greater than current node's char recurse on right
             if (pattern[index] > curr->nodeLabel) {
                 predictUnderscoresHelper(pattern, currentProgress, index,
-                                         curr->right, numCompletions);
+                                         curr->right, numCompletions,
+                                         underscorePQ, budget);
             }
         }
     }
 }
 
+/**
+ * Multi pattern underscore helper
+ * walks one level of the ternary tree, left and right only where an
+ * active pattern node has a letter on that side or a '_', and moves
+ * every active pattern node along with each letter it accepts. Nodes
+ * are visited in the order predictUnderscoresHelper visits them, so
+ * frequency ties are settled the same way
+ */
+void DictionaryTrie::underscoresManyHelper(
+    DictionaryTrieNode* curr, const vector<PatternNode>& patternTrie,
+    const vector<unsigned int>& active, bool wildcard, char minLetter,
+    char maxLetter, string& prefix, unsigned int numCompletions,
+    vector<WordPQ>& completions) const {
+    if (curr == nullptr) {
+        return;
+    }
+    if (wildcard || minLetter < curr->nodeLabel) {
+        underscoresManyHelper(curr->left, patternTrie, active, wildcard,
+                              minLetter, maxLetter, prefix, numCompletions,
+                              completions);
+    }
+    if (wildcard || maxLetter > curr->nodeLabel) {
+        underscoresManyHelper(curr->right, patternTrie, active, wildcard,
+                              minLetter, maxLetter, prefix, numCompletions,
+                              completions);
+    }
+
+    // the pattern nodes that accept this letter
+    vector<unsigned int> next;
+    bool nextWildcard = false;
+    char nextMin = CHAR_MAX;
+    char nextMax = CHAR_MIN;
+    bool hasChildren = false;
+    for (unsigned int i = 0; i < active.size(); i++) {
+        for (auto& child : patternTrie[active[i]].children) {
+            if (child.first == '_' || child.first == curr->nodeLabel) {
+                const PatternNode& node = patternTrie[child.second];
+                next.push_back(child.second);
+                nextWildcard = nextWildcard || node.wildcard;
+                nextMin = min(nextMin, node.minLetter);
+                nextMax = max(nextMax, node.maxLetter);
+                hasChildren = hasChildren || !node.children.empty();
+            }
+        }
+    }
+    if (next.empty()) {
+        return;
+    }
+
+    prefix.push_back(curr->nodeLabel);
+    if (curr->isWordNode) {
+        for (unsigned int i = 0; i < next.size(); i++) {
+            for (unsigned int pattern : patternTrie[next[i]].patterns) {
+                WordPQ& pq = completions[pattern];
+                if (pq.size() < numCompletions) {
+                    pq.push(pair<int, string>(curr->Frequency, prefix));
+                } else if ((int)curr->Frequency > pq.top().first) {
+                    pq.pop();
+                    pq.push(pair<int, string>(curr->Frequency, prefix));
+                }
+            }
+        }
+    }
+    if (hasChildren) {
+        underscoresManyHelper(curr->child, patternTrie, next, nextWildcard,
+                              nextMin, nextMax, prefix, numCompletions,
+                              completions);
+    }
+    prefix.pop_back();
+}
+
 /**
  * Destructor Helper
  * Recursively deletes all nodes
@@ -450,3 +1169,160 @@ void DictionaryTrie::deleteAll(DictionaryTrieNode* root) {
     deleteAll(root->child);
     delete root;
 }
+
+/**
+ * Collect Words Helper
+ * In order traversal, smaller letters on the left come first, then the
+ * word ending here, then longer words below, then larger letters
+ */
+void DictionaryTrie::collectWordsHelper(
+    DictionaryTrieNode* curr, string& prefix,
+    vector<pair<unsigned int, string>>& words) const {
+    if (curr == nullptr) {
+        return;
+    }
+
+    collectWordsHelper(curr->left, prefix, words);
+
+    prefix.push_back(curr->nodeLabel);
+    if (curr->isWordNode) {
+        words.push_back(pair<unsigned int, string>(curr->Frequency, prefix));
+    }
+    collectWordsHelper(curr->child, prefix, words);
+    prefix.pop_back();
+
+    collectWordsHelper(curr->right, prefix, words);
+}
+
+/**
+ * Stats Helper
+ * Recursively visits every node, siblings counts the nodes in the
+ * left/right subtree curr belongs to (the fan-out of its parent)
+ */
+unsigned int DictionaryTrie::collectStats(DictionaryTrieNode* curr,
+                                          unsigned int level,
+                                          unsigned int depth,
+                                          TrieStats& stats,
+                                          unsigned int& siblings) const {
+    if (curr == nullptr) {
+        return 0;
+    }
+
+    stats.nodeCount++;
+    siblings++;
+
+    // left and right stay on the same character, but cost one more visit
+    unsigned int leftHeight =
+        collectStats(curr->left, level, depth + 1, stats, siblings);
+    unsigned int rightHeight =
+        collectStats(curr->right, level, depth + 1, stats, siblings);
+
+    // child moves to the next character
+    unsigned int fanOut = 0;
+    collectStats(curr->child, level + 1, depth + 1, stats, fanOut);
+
+    if (curr->isWordNode) {
+        stats.wordCount++;
+        stats.totalSearchDepth += depth;
+        stats.maxSearchDepth = max(stats.maxSearchDepth, depth);
+    }
+
+    if (stats.fanOut.size() <= fanOut) {
+        stats.fanOut.resize(fanOut + 1, 0);
+    }
+    stats.fanOut[fanOut]++;
+
+    if (stats.levels.size() <= level) {
+        stats.levels.resize(level + 1);
+    }
+    TrieStats::LevelStats& levelStats = stats.levels[level];
+    unsigned int imbalance = leftHeight > rightHeight
+                                 ? leftHeight - rightHeight
+                                 : rightHeight - leftHeight;
+    levelStats.nodes++;
+    levelStats.leftLinks += curr->left != nullptr;
+    levelStats.rightLinks += curr->right != nullptr;
+    levelStats.totalImbalance += imbalance;
+    levelStats.maxImbalance = max(levelStats.maxImbalance, imbalance);
+
+    return 1 + max(leftHeight, rightHeight);
+}
+
+/**
+ * Completion iterator entry order
+ * higher bounds come out first. Among equal bounds subtries are
+ * expanded before any word comes out, so every word of that frequency
+ * is queued by then and they come out alphabetically
+ */
+bool DictionaryTrie::CompletionIterator::EntryComparator::operator()(
+    const Entry& e1, const Entry& e2) const {
+    if (e1.bound != e2.bound) {
+        return e1.bound < e2.bound;
+    }
+    bool isWord1 = e1.node == nullptr;
+    bool isWord2 = e2.node == nullptr;
+    if (isWord1 != isWord2) {
+        return isWord1;
+    }
+    return e1.text > e2.text;
+}
+
+/* queues the subtrie of node if it is not empty */
+void DictionaryTrie::CompletionIterator::pushSubtrie(
+    const DictionaryTrieNode* node, const string& text) {
+    if (node != nullptr) {
+        frontier.push(Entry{node->maxFrequency, node, text});
+    }
+}
+
+/* expands subtries until a word is on top, each expansion spent
+ * from budget if given
+ * @return false if no word is left or the budget ran out
+ **/
+bool DictionaryTrie::CompletionIterator::advance(QueryBudget* budget) {
+    while (!frontier.empty() && frontier.top().node != nullptr) {
+        if (budget != nullptr && !budget->spend()) {
+            return false;
+        }
+        Entry entry = frontier.top();
+        frontier.pop();
+        const DictionaryTrieNode* node = entry.node;
+
+        pushSubtrie(node->left, entry.text);
+        pushSubtrie(node->right, entry.text);
+        entry.text.push_back(node->nodeLabel);
+        if (node->isWordNode) {
+            frontier.push(Entry{node->Frequency, nullptr, entry.text});
+        }
+        pushSubtrie(node->child, entry.text);
+    }
+    return !frontier.empty();
+}
+
+/* true if there are completions left */
+bool DictionaryTrie::CompletionIterator::hasNext() { return advance(); }
+
+/* the next completion, "" once there are none left */
+string DictionaryTrie::CompletionIterator::next() {
+    if (!advance()) {
+        return "";
+    }
+    string word = frontier.top().text;
+    frontier.pop();
+    return word;
+}
+
+/* the next completions with their frequencies
+ * @param pageSize, the most completions to return
+ * @return up to pageSize <frequency, word> pairs, best first
+ **/
+vector<pair<unsigned int, string>>
+DictionaryTrie::CompletionIterator::nextPage(unsigned int pageSize) {
+    vector<pair<unsigned int, string>> page;
+    while (page.size() < pageSize && advance()) {
+        page.push_back(pair<unsigned int, string>(frontier.top().bound,
+                                                  frontier.top().text));
+        frontier.pop();
+    }
+    return page;
+}
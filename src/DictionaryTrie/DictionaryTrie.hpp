@@ -1,7 +1,6 @@
 /**
  * This hpp file defines the functions and structure
- * of the DictionaryTrie, the DictionaryTrieNode,
- * and the wordComparator for comparing <string, int> pairs
+ * of the DictionaryTrie and the DictionaryTrieNode
  *
  * Authors: Joseph Mattingly
  *          Bijan Afghani
@@ -9,30 +8,99 @@
 #ifndef DICTIONARY_TRIE_HPP
 #define DICTIONARY_TRIE_HPP
 
+#include <atomic>
+#include <chrono>
+#include <climits>
 #include <queue>
 #include <string>
 #include <utility>
 #include <vector>
+#include "DictionaryEngine.hpp"
 
 using namespace std;
 
-/* comparator structure for comparing pairs
- * This compares <string, int> pairs
- * first the strings are compared in alphabetically
- * If the strings are equal we compare the ints
- * the smaller int is returned.
+class InfixIndex;
+class WordIndex;
+
+/* limits on the work of one query, and whether the query hit them.
+ * A query that runs out stops where it is and returns the best words
+ * it found so far
  */
-struct wordComparator {
-    // operator takes in two pairs of <int, string>
-    bool operator()(const pair<int, string>& p1, const pair<int, string>& p2) {
-        // if the frequencies are equal sort by alphabetical order
-        if (p1.first == p2.first) {
-            return p1.second < p2.second;
+struct QueryBudget {
+    unsigned long long maxVisits;  // nodes a query may visit, 0 for no limit
+    chrono::steady_clock::time_point deadline;
+    bool hasDeadline;
+    unsigned long long visits = 0;  // nodes visited so far
+    bool exhausted = false;         // true if the answer is incomplete
+
+    /* a budget of maxVisits nodes and timeLimit from now, 0 for none */
+    QueryBudget(unsigned long long maxVisits = 0,
+                chrono::nanoseconds timeLimit = chrono::nanoseconds::zero())
+        : maxVisits(maxVisits),
+          deadline(chrono::steady_clock::now() + timeLimit),
+          hasDeadline(timeLimit > chrono::nanoseconds::zero()) {}
+
+    /* counts a visit, the clock is read every 64 of them
+     * @return false once the budget is used up
+     **/
+    bool spend() {
+        if (exhausted) {
+            return false;
         }
-        // else sort from least to greatest frequency
-        else {
-            return p1.first > p2.first;
+        visits++;
+        if ((maxVisits != 0 && visits > maxVisits) ||
+            (hasDeadline && visits % 64 == 0 &&
+             chrono::steady_clock::now() >= deadline)) {
+            exhausted = true;
         }
+        return !exhausted;
+    }
+};
+
+/* structure describing the memory footprint and shape of a trie
+ * "levels" are character positions: level i holds the ternary nodes
+ * that can match the i-th character of a word, and the imbalance of
+ * a node is the height difference of its left and right subtrees
+ */
+struct TrieStats {
+    struct LevelStats {
+        unsigned long long nodes = 0;       // nodes at this level
+        unsigned long long leftLinks = 0;   // nodes with a left subtree
+        unsigned long long rightLinks = 0;  // nodes with a right subtree
+        unsigned long long totalImbalance = 0;
+        unsigned int maxImbalance = 0;
+    };
+
+    unsigned long long nodeCount = 0;
+    unsigned long long wordCount = 0;
+
+    // bytes by category, nodeBytes is the sum of the categories below it
+    size_t objectBytes = 0;     // the DictionaryTrie object itself
+    size_t nodeBytes = 0;       // every DictionaryTrieNode
+    size_t pointerBytes = 0;    // left/right/child/parent links
+    size_t labelBytes = 0;      // character labels and word flags
+    size_t frequencyBytes = 0;  // frequency and maxFrequency fields
+    size_t countBytes = 0;      // subtrie word counts
+    size_t paddingBytes = 0;    // alignment padding inside nodes
+    size_t indexBytes = 0;      // the WordIndex, if one was built
+    size_t infixBytes = 0;      // the InfixIndex, if one was built
+
+    // search depth of a word is the number of nodes find() visits
+    unsigned long long totalSearchDepth = 0;
+    unsigned int maxSearchDepth = 0;
+
+    vector<LevelStats> levels;
+    // fanOut[k] is the number of nodes whose child holds k distinct letters
+    vector<unsigned long long> fanOut;
+
+    /* total bytes held by the trie */
+    size_t totalBytes() const {
+        return objectBytes + nodeBytes + indexBytes + infixBytes;
+    }
+
+    /* average number of nodes visited to find a word */
+    double averageSearchDepth() const {
+        return wordCount == 0 ? 0.0 : (double)totalSearchDepth / wordCount;
     }
 };
 
@@ -40,7 +108,7 @@ struct wordComparator {
  * The class for a dictionary ADT, implemented as either
  * a multi-way trie or a ternary search tree.
  */
-class DictionaryTrie {
+class DictionaryTrie : public DictionaryEngine {
   private:
     /**
      * The class for a dictionary multi-way trie node
@@ -55,37 +123,124 @@ class DictionaryTrie {
         DictionaryTrieNode* child;
         char const nodeLabel;
         bool isWordNode;
-        unsigned int Frequency;
-        unsigned int maxFrequency;  // maximum frequency of node's subtrie
+        // atomic so recordSelection can bump them while queries run
+        atomic<unsigned int> Frequency;
+        atomic<unsigned int> maxFrequency;  // max frequency of node's subtrie
+        unsigned int subtrieWords;          // number of words in node's subtrie
 
         // Default constructor for the DictionaryTrieNode Class
         DictionaryTrieNode(char thisLabel);
     };
+    /**
+     * A node of the trie predictUnderscoresMany compiles its patterns
+     * into, one level per pattern position
+     */
+    struct PatternNode {
+        vector<pair<char, unsigned int>> children;  // letter or '_', node
+        vector<unsigned int> patterns;  // indices of patterns ending here
+        bool wildcard = false;          // true if a child is '_'
+        char minLetter = CHAR_MAX;      // smallest letter of a child
+        char maxLetter = CHAR_MIN;      // largest letter of a child
+    };
     /* method to insert a new word into the dictionary */
     DictionaryTrieNode* insertNode(string word, int currentIndex, int wordFreq,
                                    DictionaryTrieNode* currentNode);
     /* method to find a given word in the dictionary */
-    DictionaryTrieNode* findNode(string word);
+    DictionaryTrieNode* findNode(string word) const;
+    /* findNode for many prefixes, groupSize of them in flight at once */
+    void findNodeMany(const vector<string>& prefixes,
+                      vector<DictionaryTrieNode*>& nodes,
+                      unsigned int groupSize) const;
     /* depth first search for prefix (helper for predict) */
     void depthFirst(string prefix, DictionaryTrieNode* currentNode,
-                    int numCompletions);
+                    int numCompletions, WordPQ& completions) const;
+    /* number of words in the subtrie of node, 0 for nullptr */
+    static unsigned int wordsIn(const DictionaryTrieNode* node);
+    /* helper for predictUnderscoresMany, matches one trie level against
+     * every active pattern node at once */
+    void underscoresManyHelper(DictionaryTrieNode* curr,
+                               const vector<PatternNode>& patternTrie,
+                               const vector<unsigned int>& active,
+                               bool wildcard, char minLetter,
+                               char maxLetter, string& prefix,
+                               unsigned int numCompletions,
+                               vector<WordPQ>& completions) const;
     /* helper for destructor */
     void deleteAll(DictionaryTrieNode* trieRoot);
+    /* helper for collectWords, visits words in alphabetical order */
+    void collectWordsHelper(DictionaryTrieNode* curr, string& prefix,
+                            vector<pair<unsigned int, string>>& words) const;
+    /* helper for repairFrequencies, returns the max of curr's subtrie */
+    unsigned int repairHelper(DictionaryTrieNode* curr, double decay,
+                              string& prefix);
+    /* helper for stats, returns the height of curr's left/right subtree */
+    unsigned int collectStats(DictionaryTrieNode* curr, unsigned int level,
+                              unsigned int depth, TrieStats& stats,
+                              unsigned int& siblings) const;
 
   public:
     // root node of the trie, first letter of first inserted word
     DictionaryTrieNode* root;
 
-    // priority queue to store the words that predictUnderscores finds
-    priority_queue<pair<int, string>, vector<pair<int, string>>, wordComparator>
-        underscorePQ;
+    // optional hash index of every word, nullptr until buildIndex()
+    WordIndex* wordIndex;
+
+    // optional suffix index of every word, nullptr until buildInfixIndex()
+    InfixIndex* infixIndex;
 
-    // priority queue to store the words that predictCompletions finds
-    priority_queue<pair<int, string>, vector<pair<int, string>>, wordComparator>
-        thisPQ;
+    // selections recorded since the last repairFrequencies
+    atomic<unsigned long long> pendingSelections;
 
     // TODO: add private members and helper methods here
   public:
+    /**
+     * Lazily lists the completions of a prefix, best first: highest
+     * frequency first and alphabetically among equal frequencies. A
+     * best first search over the subtries, bounded by maxFrequency,
+     * expands only what the words handed out so far needed, so each
+     * page continues where the last one stopped.
+     * Inserting into the trie while an iterator is in use is not safe,
+     * and selections recorded but not yet repaired may come out of order
+     */
+    class CompletionIterator {
+      private:
+        // a word to hand out, or a subtrie still to expand whose words
+        // all have a frequency of at most bound
+        struct Entry {
+            unsigned int bound;
+            const DictionaryTrieNode* node;  // nullptr for a word
+            string text;  // the word, or the letters above node
+        };
+        /* orders entries so the top of the queue comes out first */
+        struct EntryComparator {
+            bool operator()(const Entry& e1, const Entry& e2) const;
+        };
+        priority_queue<Entry, vector<Entry>, EntryComparator> frontier;
+
+        /* queues the subtrie of node if it is not empty */
+        void pushSubtrie(const DictionaryTrieNode* node, const string& text);
+        /* expands subtries until a word is on top, each expansion spent
+         * from budget if given
+         * @return false if no word is left or the budget ran out
+         **/
+        bool advance(QueryBudget* budget = nullptr);
+
+        friend class DictionaryTrie;
+
+      public:
+        /* true if there are completions left */
+        bool hasNext();
+
+        /* the next completion, "" once there are none left */
+        string next();
+
+        /* the next completions with their frequencies
+         * @param pageSize, the most completions to return
+         * @return up to pageSize <frequency, word> pairs, best first
+         **/
+        vector<pair<unsigned int, string>> nextPage(unsigned int pageSize);
+    };
+
     /* Initializes an empty DictionaryTrie */
     DictionaryTrie();
 
@@ -102,6 +257,60 @@ class DictionaryTrie {
      **/
     bool find(string word) const;
 
+    /* finds many words, interleaving the lookups so the cache misses
+     * of up to groupSize of them overlap instead of stalling one by one
+     * @param words, the words we want to find
+     * @param groupSize, the number of lookups in flight at once
+     * @return found[i] is true if words[i] is in the dictionary
+     **/
+    vector<bool> findMany(const vector<string>& words,
+                          unsigned int groupSize = 16) const;
+
+    /* frequency of a word in the dictionary
+     * @param word we want the frequency of
+     * @return the frequency, 0 if the word is not in the dictionary
+     **/
+    unsigned int frequency(string word) const;
+
+    /* builds a hash index of every word next to the trie, kept in
+     * sync by insert. find and frequency then answer from the index
+     * in expected O(1), with a Bloom filter turning most absent words
+     * away before the table is probed. Prefix and pattern queries
+     * still walk the trie
+     **/
+    void buildIndex();
+
+    /* builds a suffix array index of every word next to the trie, kept
+     * in sync by insert, so predictInfix answers in time proportional to
+     * the fragment length and numCompletions instead of scanning every
+     * word. recordSelection does not reach it, repairFrequencies copies
+     * the trie's frequencies into it, so it ranks words as the trie does
+     * after every repair
+     * @param tokenStartsOnly, match fragments only at the start of a
+     * space separated token, for a much smaller index
+     **/
+    void buildInfixIndex(bool tokenStartsOnly = false);
+
+    /* learns from a selected completion: adds count to the frequency of
+     * word with a relaxed atomic increment and nothing else, so it can
+     * run alongside queries and other selections without a lock. The
+     * maxFrequency of the word's ancestors is repaired later, in a
+     * batch, by repairFrequencies
+     * @param word, the word that was selected
+     * @param count, the number of selections
+     * @return false if the word is not in the dictionary
+     **/
+    bool recordSelection(string word, unsigned int count = 1);
+
+    /* brings every maxFrequency up to date after recordSelection, first
+     * scaling every frequency by decay (rounded down, never below 1)
+     * when decay is below 1, and brings the infix index up to date.
+     * Runs alongside queries and recordSelection but not alongside insert
+     * @param decay, the factor frequencies are scaled by
+     * @return the number of selections recorded since the last repair
+     **/
+    unsigned long long repairFrequencies(double decay = 1.0);
+
     /* predicts words given a prefix based on words with
      * the highest frequencies
      * @param prefix, the prefix we want to complete
@@ -109,7 +318,32 @@ class DictionaryTrie {
      * @return a vector of suggested completions
      **/
     vector<string> predictCompletions(string prefix,
-                                      unsigned int numCompletions);
+                                      unsigned int numCompletions) const;
+
+    /* number of words starting with prefix, in O(prefix length) from the
+     * word counts every node keeps of its subtrie
+     * @param prefix, the prefix we want to count, "" counts every word
+     * @return the number of words in the dictionary starting with prefix
+     **/
+    unsigned int countPrefix(string prefix) const;
+
+    /* lazily lists every completion of a prefix, best first. Frequency
+     * ties aside, the first numCompletions of them are the words
+     * predictCompletions returns, which lists them the other way round
+     * @param prefix, the prefix we want to complete, "" lists every word
+     * @return an iterator, valid as long as the trie
+     **/
+    CompletionIterator completions(string prefix) const;
+
+    /* predictCompletions within a budget. The words are looked at best
+     * first, so the ones found before the budget runs out are the best
+     * ones, only fewer of them
+     * @param budget, the limits, exhausted is set if they were hit
+     * @return a vector of suggested completions, in the same order
+     **/
+    vector<string> predictCompletions(string prefix,
+                                      unsigned int numCompletions,
+                                      QueryBudget& budget) const;
 
     /* predicts words given a pattern with underscores
      * @param pattern, the pattern we want to complete
@@ -117,15 +351,93 @@ class DictionaryTrie {
      * @return a vector of suggested completions
      **/
     vector<string> predictUnderscores(string pattern,
-                                      unsigned int numCompletions);
+                                      unsigned int numCompletions) const;
+
+    /* predictUnderscores within a budget, returning the best matches
+     * found before it ran out
+     * @param budget, the limits, exhausted is set if they were hit
+     * @return a vector of suggested completions, in the same order
+     **/
+    vector<string> predictUnderscores(string pattern,
+                                      unsigned int numCompletions,
+                                      QueryBudget& budget) const;
+
+    /* predicts words containing a fragment anywhere, not only at the
+     * start, based on words with the highest frequencies. Scans every
+     * word unless buildInfixIndex was called
+     * @param fragment, the text the words must contain
+     * @param numCompletions, the number of suggestions we want
+     * @return a vector of suggested completions
+     **/
+    vector<string> predictInfix(string fragment,
+                                unsigned int numCompletions) const;
+
+    /* predictUnderscores for many patterns in one walk of the trie: the
+     * patterns are compiled into a trie of their own, so patterns that
+     * start alike share their matching, and every dictionary node is
+     * visited at most once for all of them
+     * @param patterns, the patterns we want to complete
+     * @param numCompletions, the number of suggestions we want for each
+     * @return the predictUnderscores answer of every pattern, in order
+     **/
+    vector<vector<string>> predictUnderscoresMany(
+        const vector<string>& patterns, unsigned int numCompletions) const;
+
+    /* adds the best completions of a prefix to a priority queue
+     * @param prefix, the prefix we want to complete
+     * @param numCompletions, the most words completions may hold
+     * @param completions, queue of <frequency, word> pairs to add to
+     **/
+    void collectCompletions(string prefix, unsigned int numCompletions,
+                            WordPQ& completions) const;
+
+    /* adds the best matches of an underscore pattern to a priority queue
+     * @param pattern, the pattern we want to complete
+     * @param numCompletions, the most words completions may hold
+     * @param completions, queue of <frequency, word> pairs to add to
+     **/
+    void collectUnderscores(string pattern, unsigned int numCompletions,
+                            WordPQ& completions) const;
+
+    /* adds the best words containing a fragment to a priority queue
+     * @param fragment, the text the words must contain
+     * @param numCompletions, the most words completions may hold
+     * @param completions, queue of <frequency, word> pairs to add to
+     **/
+    void collectInfix(string fragment, unsigned int numCompletions,
+                      WordPQ& completions) const;
+
+    /* builds the trie from words grouped by first letter, each group
+     * becomes a subtrie on one of numThreads threads and the subtries
+     * are then hung off the root level in the order of the groups
+     * @param groups, <frequency, word> pairs sharing a first letter,
+     * ordered by the first appearance of that letter
+     * @param numThreads, the number of threads building subtries
+     **/
+    void buildParallel(const vector<vector<pair<unsigned int, string>>>& groups,
+                       unsigned int numThreads);
+
+    /* lists every word in the dictionary
+     * @param words, receives the <frequency, word> pairs in
+     * alphabetical order
+     **/
+    void collectWords(vector<pair<unsigned int, string>>& words) const;
+
+    /* measures the memory footprint and shape of the trie
+     * @return node and word counts, bytes by category, search depths,
+     * per level imbalance and the fan-out distribution
+     **/
+    TrieStats stats() const;
 
     /**
-     * predict underscore helper
+     * predict underscore helper, every node visited is spent from budget
+     * if given
      */
     void predictUnderscoresHelper(string pattern, string patternInProgress,
                                   int currIndex,
                                   DictionaryTrieNode* currentNode,
-                                  int numCompletions);
+                                  int numCompletions, WordPQ& completions,
+                                  QueryBudget* budget = nullptr) const;
 
     /* Destructor for the DictionaryTrie object to avoid memory leaks */
     ~DictionaryTrie();
@@ -0,0 +1,517 @@
+/**
+ * This file implements the DurableDictionary
+ * defined in DurableDictionary.hpp
+ */
+#include "DurableDictionary.hpp"
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <climits>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include "util.hpp"
+
+static const char* CHECKPOINT_HEADER = "#checkpoint ";
+
+/* writes all of data to fd, retrying short writes */
+static bool writeAll(int fd, const string& data) {
+    size_t written = 0;
+    while (written < data.size()) {
+        ssize_t bytes = write(fd, data.data() + written, data.size() - written);
+        if (bytes < 0 && errno == EINTR) {
+            continue;
+        }
+        if (bytes < 0) {
+            return false;
+        }
+        written += bytes;
+    }
+    return true;
+}
+
+/* fsyncs a directory, so a rename inside it is durable */
+static bool syncDirectory(const string& directory) {
+    int fd = ::open(directory.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+    bool synced = fsync(fd) == 0;
+    close(fd);
+    return synced;
+}
+
+/* writes data to path through a synced temporary file and a rename */
+static bool replaceFile(const string& directory, const string& path,
+                        const string& data) {
+    string temporary = path + ".tmp";
+    int fd = ::open(temporary.c_str(),
+                    O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+    if (fd < 0) {
+        return false;
+    }
+    bool written = writeAll(fd, data) && fdatasync(fd) == 0;
+    close(fd);
+    return written && rename(temporary.c_str(), path.c_str()) == 0 &&
+           syncDirectory(directory);
+}
+
+/* median first order of words[first, last), so that inserting the
+ * lines in file order builds balanced left/right subtrees
+ */
+static void appendBalanced(const vector<pair<unsigned int, string>>& words,
+                           size_t first, size_t last, string& out) {
+    if (first >= last) {
+        return;
+    }
+    size_t middle = first + (last - first) / 2;
+    out += to_string(words[middle].first);
+    out += ' ';
+    out += words[middle].second;
+    out += '\n';
+    appendBalanced(words, first, middle, out);
+    appendBalanced(words, middle + 1, last, out);
+}
+
+/* reads an unsigned decimal number filling all of text
+ * @return false if text is anything else or does not fit in max
+ */
+static bool parseNumber(const string& text, unsigned long long max,
+                        unsigned long long& number) {
+    if (text.empty() || text[0] < '0' || text[0] > '9') {
+        return false;
+    }
+    char* end;
+    errno = 0;
+    number = strtoull(text.c_str(), &end, 10);
+    return *end == '\0' && errno != ERANGE && number <= max;
+}
+
+/* splits a log line into its lsn, op, word and the count (I, S) or
+ * decay (D) of its argument
+ * @return false if the line is not a valid log record
+ */
+static bool parseRecord(const string& line, unsigned long long& lsn,
+                        char& op, unsigned int& count, double& decay,
+                        string& word) {
+    size_t opStart = line.find(' ');
+    if (opStart == string::npos || opStart + 2 >= line.length() ||
+        line[opStart + 2] != ' ' ||
+        !parseNumber(line.substr(0, opStart), ULLONG_MAX, lsn)) {
+        return false;
+    }
+    op = line[opStart + 1];
+
+    size_t argumentStart = opStart + 3;
+    size_t wordStart = line.find(' ', argumentStart);
+    if (wordStart == string::npos) {
+        return false;
+    }
+    string argument = line.substr(argumentStart, wordStart - argumentStart);
+    word = line.substr(wordStart + 1);
+
+    if (op == 'I' || op == 'S') {
+        unsigned long long number;
+        if (!parseNumber(argument, UINT_MAX, number)) {
+            return false;
+        }
+        count = number;
+        return true;
+    }
+    if (op == 'D') {
+        char* end;
+        errno = 0;
+        decay = argument.empty() ? -1.0 : strtod(argument.c_str(), &end);
+        return !argument.empty() && *end == '\0' && errno != ERANGE &&
+               decay >= 0.0 && decay <= 1.0;
+    }
+    return false;
+}
+
+/**
+ * Durable dictionary constructor
+ * @param syncInterval time between background log syncs
+ * @param checkpointBytes log size that triggers a checkpoint
+ * @param loadThreads threads loading the checkpoint
+ */
+DurableDictionary::DurableDictionary(chrono::milliseconds syncInterval,
+                                     size_t checkpointBytes,
+                                     unsigned int loadThreads)
+    : syncInterval(syncInterval),
+      checkpointBytes(checkpointBytes),
+      loadThreads(loadThreads),
+      numReplayed(0),
+      nextLsn(1),
+      logFd(-1),
+      logBytes(0),
+      failed(false),
+      stopping(false) {}
+
+/* opens the dictionary kept in directory, creating the directory if
+ * needed. Without a checkpoint the words are loaded from seed (a
+ * dictionary file, if given) and the first checkpoint is written
+ * @return true on success, false with a message on cerr otherwise
+ **/
+bool DurableDictionary::open(const string& directory, istream* seed) {
+    if (logFd >= 0) {
+        cerr << "Dictionary already open" << endl;
+        return false;
+    }
+    this->directory = directory;
+    if (mkdir(directory.c_str(), 0755) < 0 && errno != EEXIST) {
+        cerr << "Cannot create " << directory << ": " << strerror(errno)
+             << endl;
+        return false;
+    }
+
+    bool seeded = false;
+    unsigned long long checkpointLsn = 0;
+    ifstream probe(directory + "/checkpoint");
+    if (probe.is_open()) {
+        probe.close();
+        if (!loadCheckpoint(checkpointLsn)) {
+            return false;
+        }
+    } else if (seed != nullptr) {
+        Utils::loadDictParallel(dict, *seed, loadThreads);
+        seeded = true;
+    }
+
+    if (!replayLog(checkpointLsn)) {
+        return false;
+    }
+    logFd = ::open((directory + "/wal").c_str(),
+                   O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (logFd < 0) {
+        cerr << "Cannot open the log in " << directory << ": "
+             << strerror(errno) << endl;
+        return false;
+    }
+    if (seeded && !checkpoint()) {
+        return false;
+    }
+
+    syncer = thread(&DurableDictionary::syncLoop, this);
+    return true;
+}
+
+/* true if the checkpoint's dictionary file line for word reads back as
+ * the same word, which is not the case for a word with a newline, a tab,
+ * a leading, trailing or doubled space or a "." word
+ */
+static bool checkpointable(const string& word) {
+    unsigned int freq;
+    string parsed;
+    Utils::parseLine("1 " + word, freq, parsed);
+    return parsed == word;
+}
+
+/* inserts and logs a new word
+ * @return true if inserted false if duplicate, not checkpointable, or if
+ * the log failed
+ **/
+bool DurableDictionary::insert(string word, unsigned int freq) {
+    unique_lock<shared_timed_mutex> guard(trieLock);
+    if (failed || !checkpointable(word) || !dict.insert(word, freq)) {
+        return false;
+    }
+    lock_guard<mutex> logging(logLock);
+    append('I', to_string(freq), word);
+    return true;
+}
+
+/* DictionaryTrie::recordSelection, logged, false if the log failed */
+bool DurableDictionary::recordSelection(string word, unsigned int count) {
+    shared_lock<shared_timed_mutex> guard(trieLock);
+    if (failed || !dict.recordSelection(word, count)) {
+        return false;
+    }
+    lock_guard<mutex> logging(logLock);
+    append('S', to_string(count), word);
+    return true;
+}
+
+/* DictionaryTrie::repairFrequencies, the decay is logged */
+unsigned long long DurableDictionary::repairFrequencies(double decay) {
+    // exclusive, so selections land in the log on the same side of
+    // the decay as in the trie
+    unique_lock<shared_timed_mutex> guard(trieLock);
+    unsigned long long selections = dict.repairFrequencies(decay);
+    if (decay < 1.0) {
+        ostringstream argument;
+        argument << setprecision(17) << decay;
+        lock_guard<mutex> logging(logLock);
+        append('D', argument.str(), "");
+    }
+    return selections;
+}
+
+/* finds a word in the dictionary
+ * @return true if found false otherwise
+ **/
+bool DurableDictionary::find(string word) const {
+    shared_lock<shared_timed_mutex> guard(trieLock);
+    return dict.find(word);
+}
+
+/* frequency of a word, 0 if it is not in the dictionary */
+unsigned int DurableDictionary::frequency(string word) const {
+    shared_lock<shared_timed_mutex> guard(trieLock);
+    return dict.frequency(word);
+}
+
+/* DictionaryTrie::predictCompletions */
+vector<string> DurableDictionary::predictCompletions(
+    string prefix, unsigned int numCompletions) const {
+    shared_lock<shared_timed_mutex> guard(trieLock);
+    return dict.predictCompletions(prefix, numCompletions);
+}
+
+/* DictionaryTrie::predictUnderscores */
+vector<string> DurableDictionary::predictUnderscores(
+    string pattern, unsigned int numCompletions) const {
+    shared_lock<shared_timed_mutex> guard(trieLock);
+    return dict.predictUnderscores(pattern, numCompletions);
+}
+
+/* writes and fdatasyncs every record logged so far
+ * @return false with a message on cerr if the log cannot be written
+ **/
+bool DurableDictionary::sync() {
+    lock_guard<mutex> writing(writeLock);
+    string batch;
+    {
+        lock_guard<mutex> logging(logLock);
+        batch.swap(pending);
+    }
+    if (batch.empty() || logFd < 0) {
+        return true;
+    }
+    // mutations keep appending to the buffer while this one is written
+    if (!writeAll(logFd, batch) || fdatasync(logFd) != 0) {
+        cerr << "Cannot write the log in " << directory << ": "
+             << strerror(errno) << endl;
+        // cut what part of the batch was written, so the next write does
+        // not continue a torn line, and keep the batch for a later retry
+        if (ftruncate(logFd, logBytes) != 0) {
+            cerr << "Cannot cut the log in " << directory << ": "
+                 << strerror(errno) << endl;
+        }
+        {
+            lock_guard<mutex> logging(logLock);
+            pending.insert(0, batch);
+        }
+        failed = true;
+        return false;
+    }
+    logBytes += batch.size();
+    return true;
+}
+
+/* writes a checkpoint of the whole trie and drops the log records
+ * it covers. Mutations wait only while the words are copied
+ * @return false with a message on cerr if a file cannot be written
+ **/
+bool DurableDictionary::checkpoint() {
+    lock_guard<mutex> checkpointing(checkpointLock);
+    vector<pair<unsigned int, string>> words;
+    unsigned long long lsn;
+    {
+        unique_lock<shared_timed_mutex> guard(trieLock);
+        lock_guard<mutex> logging(logLock);
+        dict.collectWords(words);
+        lsn = nextLsn - 1;
+    }
+
+    string data = CHECKPOINT_HEADER + to_string(lsn) + '\n';
+    appendBalanced(words, 0, words.size(), data);
+    if (!replaceFile(directory, directory + "/checkpoint", data)) {
+        cerr << "Cannot write a checkpoint in " << directory << ": "
+             << strerror(errno) << endl;
+        return false;
+    }
+
+    // every record up to lsn is in the buffer or the file by now
+    if (!sync()) {
+        return false;
+    }
+    lock_guard<mutex> writing(writeLock);
+    return compactLog(lsn);
+}
+
+/**
+ * Destructor
+ * what was logged is synced, the checkpoint is left for the next open
+ */
+DurableDictionary::~DurableDictionary() {
+    if (syncer.joinable()) {
+        {
+            lock_guard<mutex> guard(wakeLock);
+            stopping = true;
+        }
+        wake.notify_one();
+        syncer.join();
+    }
+    sync();
+    if (logFd >= 0) {
+        close(logFd);
+    }
+}
+
+/**
+ * Append Helper
+ * records are text lines, a torn last line is detected by its
+ * missing newline
+ */
+void DurableDictionary::append(char op, const string& argument,
+                               const string& word) {
+    pending += to_string(nextLsn++);
+    pending += ' ';
+    pending += op;
+    pending += ' ';
+    pending += argument;
+    pending += ' ';
+    pending += word;
+    pending += '\n';
+}
+
+/**
+ * Checkpoint Helper
+ * the lines after the header are a dictionary file
+ */
+bool DurableDictionary::loadCheckpoint(unsigned long long& checkpointLsn) {
+    ifstream in(directory + "/checkpoint", ios::binary);
+    string header;
+    getline(in, header);
+    size_t headerLength = strlen(CHECKPOINT_HEADER);
+    if (header.compare(0, headerLength, CHECKPOINT_HEADER) != 0) {
+        cerr << "Not a checkpoint: " << directory << "/checkpoint" << endl;
+        return false;
+    }
+    if (!parseNumber(header.substr(headerLength), ULLONG_MAX,
+                     checkpointLsn)) {
+        cerr << "Not a checkpoint: " << directory << "/checkpoint" << endl;
+        return false;
+    }
+    Utils::loadDictParallel(dict, in, loadThreads);
+    return true;
+}
+
+/**
+ * Replay Helper
+ * stops at the first line that is torn or not a valid record, and cuts the
+ * file there so new records are not appended after garbage
+ */
+bool DurableDictionary::replayLog(unsigned long long checkpointLsn) {
+    string path = directory + "/wal";
+    ifstream in(path, ios::binary);
+    string data((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    in.close();
+
+    unsigned long long lastLsn = checkpointLsn;
+    size_t start = 0;
+    size_t end;
+    while ((end = data.find('\n', start)) != string::npos) {
+        unsigned long long lsn;
+        char op;
+        unsigned int count;
+        double decay;
+        string word;
+        if (!parseRecord(data.substr(start, end - start), lsn, op, count,
+                         decay, word)) {
+            break;
+        }
+        if (lsn > checkpointLsn) {
+            if (op == 'I') {
+                dict.insert(word, count);
+            } else if (op == 'S') {
+                dict.recordSelection(word, count);
+            } else {
+                dict.repairFrequencies(decay);
+            }
+            numReplayed++;
+        }
+        lastLsn = max(lastLsn, lsn);
+        start = end + 1;
+    }
+    dict.repairFrequencies();
+
+    if (start < data.size() && truncate(path.c_str(), start) != 0) {
+        cerr << "Cannot cut the torn end of " << path << ": "
+             << strerror(errno) << endl;
+        return false;
+    }
+    nextLsn = lastLsn + 1;
+    logBytes = start;
+    return true;
+}
+
+/**
+ * Compact Helper
+ * the records after lsn are copied to a new log that replaces the old
+ * one, so a crash leaves either log whole
+ */
+bool DurableDictionary::compactLog(unsigned long long lsn) {
+    string path = directory + "/wal";
+    ifstream in(path, ios::binary);
+    string data((istreambuf_iterator<char>(in)), istreambuf_iterator<char>());
+    in.close();
+
+    // records are in lsn order, keep everything from the first newer one
+    size_t start = 0;
+    size_t end;
+    while ((end = data.find('\n', start)) != string::npos) {
+        unsigned long long recordLsn;
+        char op;
+        unsigned int count;
+        double decay;
+        string word;
+        if (parseRecord(data.substr(start, end - start), recordLsn, op, count,
+                        decay, word) &&
+            recordLsn > lsn) {
+            break;
+        }
+        start = end + 1;
+    }
+
+    string kept = data.substr(start);
+    int fd = -1;
+    if (replaceFile(directory, path, kept)) {
+        fd = ::open(path.c_str(), O_WRONLY | O_APPEND | O_CLOEXEC);
+    }
+    if (fd < 0) {
+        cerr << "Cannot compact " << path << ": " << strerror(errno) << endl;
+        return false;
+    }
+    close(logFd);
+    logFd = fd;
+    logBytes = kept.size();
+    return true;
+}
+
+/**
+ * Sync Loop
+ * one fdatasync per interval covers every mutation made during it
+ */
+void DurableDictionary::syncLoop() {
+    unique_lock<mutex> guard(wakeLock);
+    while (!wake.wait_for(guard, syncInterval, [this]() { return stopping; })) {
+        guard.unlock();
+        if (!sync()) {
+            guard.lock();
+            continue;
+        }
+        bool full;
+        {
+            lock_guard<mutex> writing(writeLock);
+            full = logBytes >= checkpointBytes;
+        }
+        if (full) {
+            checkpoint();
+        }
+        guard.lock();
+    }
+}
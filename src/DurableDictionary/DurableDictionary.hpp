@@ -0,0 +1,152 @@
+/**
+ * This hpp file defines the DurableDictionary, a DictionaryTrie whose
+ * mutations survive a restart: every insert and frequency change is
+ * appended to a write-ahead log, and the whole trie is checkpointed
+ * from time to time so the log stays short
+ *
+ * The directory holds two files:
+ *  - checkpoint: "#checkpoint <lsn>" and then one "<frequency> <word>"
+ *    line per word, the dictionary file format, in median first
+ *    order so inserting the lines in order builds a balanced trie
+ *  - wal: one "<lsn> <op> <argument> <word>" line per mutation, op I
+ *    inserts, S records selections and D decays by the argument
+ * Startup loads the checkpoint and replays the log records with a
+ * larger lsn (log sequence number).
+ */
+#ifndef DURABLE_DICTIONARY_HPP
+#define DURABLE_DICTIONARY_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <iostream>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "DictionaryTrie.hpp"
+
+using namespace std;
+
+/**
+ * Mutations are applied to the trie, then appended to an in memory
+ * buffer. A background thread writes and fdatasyncs the buffer every
+ * syncInterval, so one fsync covers every mutation of the interval,
+ * and checkpoints once the log reaches checkpointBytes. sync() makes
+ * everything logged so far durable right away.
+ */
+class DurableDictionary {
+  private:
+    DictionaryTrie dict;
+    // queries share the trie, inserts and decay take it exclusively
+    mutable shared_timed_mutex trieLock;
+
+    string directory;
+    chrono::milliseconds syncInterval;
+    size_t checkpointBytes;
+    unsigned int loadThreads;
+    unsigned long long numReplayed;
+
+    // the log buffer, lock order is trieLock, then logLock
+    mutex logLock;
+    string pending;  // records not yet written
+    unsigned long long nextLsn;
+
+    // the log file, one writer at a time
+    mutex writeLock;
+    int logFd;
+    size_t logBytes;  // bytes of whole records in the file
+    // a write failed, mutations are refused from then on
+    atomic<bool> failed;
+
+    mutex checkpointLock;  // one checkpoint at a time
+
+    // background syncing
+    mutex wakeLock;
+    condition_variable wake;
+    bool stopping;
+    thread syncer;
+
+    /* appends a record to the buffer, logLock must be held */
+    void append(char op, const string& argument, const string& word);
+    /* loads the checkpoint, false if it exists but is unreadable */
+    bool loadCheckpoint(unsigned long long& checkpointLsn);
+    /* applies the log records after checkpointLsn, cuts a torn tail */
+    bool replayLog(unsigned long long checkpointLsn);
+    /* keeps only the log records after lsn, writeLock must be held */
+    bool compactLog(unsigned long long lsn);
+    /* sync thread body */
+    void syncLoop();
+
+  public:
+    /* Initializes a closed dictionary, see open() */
+    DurableDictionary(
+        chrono::milliseconds syncInterval = chrono::milliseconds(50),
+        size_t checkpointBytes = 64 * 1024 * 1024,
+        unsigned int loadThreads = thread::hardware_concurrency());
+
+    // owns a file and a thread
+    DurableDictionary(const DurableDictionary&) = delete;
+    DurableDictionary& operator=(const DurableDictionary&) = delete;
+
+    /* opens the dictionary kept in directory, creating the directory if
+     * needed. Without a checkpoint the words are loaded from seed (a
+     * dictionary file, if given) and the first checkpoint is written
+     * @return true on success, false with a message on cerr otherwise
+     **/
+    bool open(const string& directory, istream* seed = nullptr);
+
+    /* inserts and logs a new word
+     * @return true if inserted false if duplicate, or if the log failed,
+     * or if the word would not read back the same from the checkpoint
+     * (see Utils::parseLine)
+     **/
+    bool insert(string word, unsigned int freq);
+
+    /* DictionaryTrie::recordSelection, logged, false if the log failed */
+    bool recordSelection(string word, unsigned int count = 1);
+
+    /* DictionaryTrie::repairFrequencies, the decay is logged */
+    unsigned long long repairFrequencies(double decay = 1.0);
+
+    /* finds a word in the dictionary
+     * @return true if found false otherwise
+     **/
+    bool find(string word) const;
+
+    /* frequency of a word, 0 if it is not in the dictionary */
+    unsigned int frequency(string word) const;
+
+    /* DictionaryTrie::predictCompletions */
+    vector<string> predictCompletions(string prefix,
+                                      unsigned int numCompletions) const;
+
+    /* DictionaryTrie::predictUnderscores */
+    vector<string> predictUnderscores(string pattern,
+                                      unsigned int numCompletions) const;
+
+    /* writes and fdatasyncs every record logged so far. A failed write
+     * is cut from the file and kept for the next sync, and insert and
+     * recordSelection refuse new mutations from then on
+     * @return false with a message on cerr if the log cannot be written
+     **/
+    bool sync();
+
+    /* true once a log write has failed */
+    bool logFailed() const { return failed; }
+
+    /* writes a checkpoint of the whole trie and drops the log records
+     * it covers. Mutations wait only while the words are copied
+     * @return false with a message on cerr if a file cannot be written
+     **/
+    bool checkpoint();
+
+    /* number of log records replayed by open() */
+    unsigned long long replayedRecords() const { return numReplayed; }
+
+    /* Destructor, syncs the log and stops the sync thread */
+    ~DurableDictionary();
+};
+
+#endif  // DURABLE_DICTIONARY_HPP
@@ -0,0 +1,76 @@
+/**
+ * This file implements the FrequencyLearner
+ * defined in FrequencyLearner.hpp
+ */
+#include "FrequencyLearner.hpp"
+#include <cmath>
+
+/* decay is saved up until it takes off at least this much, frequencies
+ * are integers and tiny factors would round away
+ */
+static const double MIN_DECAY_STEP = 0.9;
+
+/**
+ * Learner constructor
+ * @param dict the dictionary whose frequencies are learned
+ * @param interval time between repair passes
+ * @param halfLife time for a frequency to decay to half, 0 for none
+ */
+FrequencyLearner::FrequencyLearner(DictionaryTrie& dict,
+                                   chrono::milliseconds interval,
+                                   chrono::milliseconds halfLife)
+    : dict(dict),
+      interval(interval),
+      halfLife(halfLife),
+      numPasses(0),
+      stopping(false) {
+    learner = thread(&FrequencyLearner::learnLoop, this);
+}
+
+/* number of repair passes run so far */
+unsigned long long FrequencyLearner::passes() {
+    lock_guard<mutex> guard(wakeLock);
+    return numPasses;
+}
+
+/**
+ * Destructor
+ * the last repair folds in the selections since the previous pass
+ */
+FrequencyLearner::~FrequencyLearner() {
+    {
+        lock_guard<mutex> guard(wakeLock);
+        stopping = true;
+    }
+    wake.notify_one();
+    learner.join();
+    dict.repairFrequencies();
+}
+
+/**
+ * Learn Loop
+ * the decay follows the time that really passed between passes
+ */
+void FrequencyLearner::learnLoop() {
+    unique_lock<mutex> guard(wakeLock);
+    auto last = chrono::steady_clock::now();
+    double savedDecay = 1.0;
+    while (!wake.wait_for(guard, interval, [this]() { return stopping; })) {
+        auto now = chrono::steady_clock::now();
+        if (halfLife.count() > 0) {
+            chrono::duration<double, milli> elapsed = now - last;
+            savedDecay *= pow(0.5, elapsed.count() / halfLife.count());
+        }
+        last = now;
+
+        double decay = 1.0;
+        if (savedDecay <= MIN_DECAY_STEP) {
+            decay = savedDecay;
+            savedDecay = 1.0;
+        }
+        guard.unlock();
+        dict.repairFrequencies(decay);
+        guard.lock();
+        numPasses++;
+    }
+}
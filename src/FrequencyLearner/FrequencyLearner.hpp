@@ -0,0 +1,54 @@
+/**
+ * This hpp file defines the FrequencyLearner, which runs the batched
+ * repairFrequencies pass of a DictionaryTrie on a background thread,
+ * optionally decaying every frequency with a half life
+ */
+#ifndef FREQUENCY_LEARNER_HPP
+#define FREQUENCY_LEARNER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include "DictionaryTrie.hpp"
+
+using namespace std;
+
+/**
+ * Calls dict.repairFrequencies every interval. With a half life,
+ * frequencies are scaled by 0.5^(elapsed / halfLife) on every pass,
+ * so selections made a half life ago count half as much as new ones.
+ * Selections themselves are recorded with dict.recordSelection.
+ * Nothing may insert into dict while the learner runs.
+ */
+class FrequencyLearner {
+  private:
+    DictionaryTrie& dict;
+    chrono::milliseconds interval;
+    chrono::milliseconds halfLife;  // 0 for no decay
+    unsigned long long numPasses;
+    mutex wakeLock;
+    condition_variable wake;
+    bool stopping;
+    thread learner;
+
+    /* learner thread body */
+    void learnLoop();
+
+  public:
+    /* Initializes a learner repairing dict every interval */
+    FrequencyLearner(DictionaryTrie& dict, chrono::milliseconds interval,
+                     chrono::milliseconds halfLife = chrono::milliseconds(0));
+
+    // owns the learner thread
+    FrequencyLearner(const FrequencyLearner&) = delete;
+    FrequencyLearner& operator=(const FrequencyLearner&) = delete;
+
+    /* number of repair passes run so far */
+    unsigned long long passes();
+
+    /* Destructor, stops the thread after one last repair */
+    ~FrequencyLearner();
+};
+
+#endif  // FREQUENCY_LEARNER_HPP
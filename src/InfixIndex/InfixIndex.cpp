@@ -0,0 +1,231 @@
+/**
+ * This file implements the InfixIndex
+ * defined in InfixIndex.hpp
+ */
+#include "InfixIndex.hpp"
+#include <string.h>
+#include <algorithm>
+#include <unordered_set>
+
+/* new words wait unsorted until they are this many, or 1/PENDING_SHARE
+ * of the indexed words if that is more, then the array is rebuilt
+ */
+static const size_t MIN_PENDING = 256;
+static const size_t PENDING_SHARE = 32;
+
+/* true if a token of word starts at position i */
+static bool startsToken(const char* word, size_t i) {
+    return word[i] != ' ' && (i == 0 || word[i - 1] == ' ');
+}
+
+/* Initializes an index of words, <frequency, word> pairs the caller
+ * keeps distinct. With tokenStartsOnly only the suffixes starting a
+ * space separated token are indexed
+ **/
+InfixIndex::InfixIndex(const vector<pair<unsigned int, string>>& words,
+                       bool tokenStartsOnly)
+    : tokenStartsOnly(tokenStartsOnly), numIndexed(0) {
+    for (unsigned int i = 0; i < words.size(); i++) {
+        if (!words[i].second.empty() && words[i].first > 0) {
+            starts.push_back(text.size());
+            frequencies.push_back(words[i].first);
+            text += words[i].second;
+            text.push_back('\0');
+        }
+    }
+    rebuild();
+}
+
+/* adds a word that is not in the index yet
+ * @return false, and nothing is added, if the word is empty or has
+ * frequency 0
+ **/
+bool InfixIndex::insert(const string& word, unsigned int freq) {
+    if (word.empty() || freq == 0) {
+        return false;
+    }
+    starts.push_back(text.size());
+    frequencies.push_back(freq);
+    text += word;
+    text.push_back('\0');
+
+    if (size() - numIndexed > max(MIN_PENDING, numIndexed / PENDING_SHARE)) {
+        rebuild();
+    }
+    return true;
+}
+
+/* the words containing fragment with the highest frequencies
+ * @param fragment, the text the words must contain
+ * @param k, the most words to return
+ * @return up to k word ids, highest frequency first and
+ * alphabetically among equal frequencies, none for ""
+ **/
+vector<unsigned int> InfixIndex::search(const string& fragment,
+                                        unsigned int k) const {
+    vector<unsigned int> found;
+    if (fragment.empty() || k == 0) {
+        return found;
+    }
+    const char* base = text.c_str();
+    const char* target = fragment.c_str();
+    size_t length = fragment.length();
+
+    // the suffixes starting with fragment form one range of the array
+    size_t first =
+        lower_bound(suffixes.begin(), suffixes.end(), target,
+                    [&](const Suffix& suffix, const char* target) {
+                        return strcmp(base + suffix.position, target) < 0;
+                    }) -
+        suffixes.begin();
+    size_t last =
+        upper_bound(suffixes.begin() + first, suffixes.end(), target,
+                    [&](const char* target, const Suffix& suffix) {
+                        return strncmp(base + suffix.position, target,
+                                       length) > 0;
+                    }) -
+        suffixes.begin();
+
+    // best first search over the range: take the best suffix of the
+    // best range, then look in the two ranges on either side of it
+    struct Range {
+        size_t first;
+        size_t last;
+        uint32_t top;  // best suffix in [first, last)
+    };
+    auto worse = [&](const Range& r1, const Range& r2) {
+        return better(suffixes[r2.top].word, suffixes[r1.top].word);
+    };
+    vector<Range> ranges;
+    if (first < last) {
+        ranges.push_back(Range{first, last, bestIn(first, last)});
+    }
+    unordered_set<uint32_t> seen;  // a word may own several suffixes
+    while (found.size() < k && !ranges.empty()) {
+        pop_heap(ranges.begin(), ranges.end(), worse);
+        Range range = ranges.back();
+        ranges.pop_back();
+
+        uint32_t word = suffixes[range.top].word;
+        if (seen.insert(word).second) {
+            found.push_back(word);
+        }
+        if (range.first < range.top) {
+            ranges.push_back(
+                Range{range.first, range.top, bestIn(range.first, range.top)});
+            push_heap(ranges.begin(), ranges.end(), worse);
+        }
+        if (range.top + 1 < range.last) {
+            ranges.push_back(Range{range.top + 1, range.last,
+                                   bestIn(range.top + 1, range.last)});
+            push_heap(ranges.begin(), ranges.end(), worse);
+        }
+    }
+
+    // the words not in the array yet are few, check them one by one
+    for (size_t id = numIndexed; id < size(); id++) {
+        const char* word = base + starts[id];
+        for (const char* match = strstr(word, target); match != nullptr;
+             match = strstr(match + 1, target)) {
+            if (!tokenStartsOnly || startsToken(word, match - word)) {
+                found.push_back(id);
+                break;
+            }
+        }
+    }
+    if (numIndexed < size()) {
+        sort(found.begin(), found.end(),
+             [&](uint32_t a, uint32_t b) { return better(a, b); });
+        found.resize(min<size_t>(found.size(), k));
+    }
+    return found;
+}
+
+/* the word with the given id */
+string InfixIndex::word(unsigned int id) const {
+    return string(text.c_str() + starts[id]);
+}
+
+/* changes the frequency of the word with the given id. Searches
+ * rank the indexed words by the old one until reorder is called
+ **/
+void InfixIndex::setFrequency(unsigned int id, unsigned int freq) {
+    __atomic_store_n(&frequencies[id], freq, __ATOMIC_RELAXED);
+}
+
+/* rebuilds the tree over the suffix array from the current
+ * frequencies, in O(number of suffixes)
+ **/
+void InfixIndex::reorder() {
+    size_t n = suffixes.size();
+    for (size_t i = n; i-- > 1;) {
+        __atomic_store_n(&best[i], bestOf(best[2 * i], best[2 * i + 1]),
+                         __ATOMIC_RELAXED);
+    }
+}
+
+/* bytes held by the words, the suffix array and the tree */
+size_t InfixIndex::sizeInBytes() const {
+    return text.size() + starts.size() * sizeof(uint32_t) +
+           frequencies.size() * sizeof(uint32_t) +
+           suffixes.size() * sizeof(Suffix) + best.size() * sizeof(uint32_t);
+}
+
+/* true if word a ranks above word b */
+bool InfixIndex::better(uint32_t a, uint32_t b) const {
+    unsigned int freqA = frequency(a);
+    unsigned int freqB = frequency(b);
+    if (freqA != freqB) {
+        return freqA > freqB;
+    }
+    return strcmp(text.c_str() + starts[a], text.c_str() + starts[b]) < 0;
+}
+
+/* the better of two suffixes, by the words they belong to */
+uint32_t InfixIndex::bestOf(uint32_t a, uint32_t b) const {
+    return better(suffixes[b].word, suffixes[a].word) ? b : a;
+}
+
+/* best suffix in suffixes[first, last), which must not be empty */
+uint32_t InfixIndex::bestIn(size_t first, size_t last) const {
+    // bottom up over the tree, leaves are at suffixes.size() + i
+    size_t n = suffixes.size();
+    uint32_t result = first;
+    for (first += n, last += n; first < last; first /= 2, last /= 2) {
+        if (first & 1) {
+            result = bestOf(result,
+                            __atomic_load_n(&best[first++], __ATOMIC_RELAXED));
+        }
+        if (last & 1) {
+            result = bestOf(result,
+                            __atomic_load_n(&best[--last], __ATOMIC_RELAXED));
+        }
+    }
+    return result;
+}
+
+/* rebuilds the suffix array and the tree over every word */
+void InfixIndex::rebuild() {
+    const char* base = text.c_str();
+    suffixes.clear();
+    for (uint32_t id = 0; id < size(); id++) {
+        const char* word = base + starts[id];
+        for (uint32_t i = 0; word[i] != '\0'; i++) {
+            if (!tokenStartsOnly || startsToken(word, i)) {
+                suffixes.push_back(Suffix{starts[id] + i, id});
+            }
+        }
+    }
+    sort(suffixes.begin(), suffixes.end(),
+         [&](const Suffix& s1, const Suffix& s2) {
+             return strcmp(base + s1.position, base + s2.position) < 0;
+         });
+
+    size_t n = suffixes.size();
+    best.assign(2 * n, 0);
+    for (size_t i = 0; i < n; i++) {
+        best[n + i] = i;
+    }
+    reorder();
+    numIndexed = size();
+}
@@ -0,0 +1,109 @@
+/**
+ * This hpp file defines the InfixIndex, a suffix array over the words
+ * of a dictionary that answers top k queries for words containing a
+ * fragment anywhere ("york" finds "new york city"), not only at the
+ * start
+ */
+#ifndef INFIX_INDEX_HPP
+#define INFIX_INDEX_HPP
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+/**
+ * The words are packed one after another in a single string, each
+ * ending with '\0', and the suffix array lists the positions where a
+ * suffix starts in the alphabetical order of the suffixes. The words
+ * containing a fragment are the ones owning the suffixes of one range
+ * of the array, found by binary search. A segment tree over the array
+ * keeps the position of the best word of every node, so the top k of
+ * the range come out one range split at a time, however many words
+ * match.
+ * New words wait in a short unsorted list, scanned by every search,
+ * until there are enough of them to be worth rebuilding the array.
+ * Frequencies can change while searches run: they and the tree are
+ * read and written with relaxed atomics, so a search running during
+ * the change may rank a few words by their old frequencies.
+ */
+class InfixIndex {
+  private:
+    struct Suffix {
+        uint32_t position;  // where the suffix starts in text
+        uint32_t word;      // id of the word it belongs to
+    };
+
+    string text;
+    vector<uint32_t> starts;       // where each word starts in text
+    vector<uint32_t> frequencies;  // frequency of each word
+    bool tokenStartsOnly;
+
+    vector<Suffix> suffixes;
+    vector<uint32_t> best;  // segment tree, best suffix of each node
+    size_t numIndexed;      // words 0 to numIndexed - 1 are in the array
+
+    /* true if word a ranks above word b */
+    bool better(uint32_t a, uint32_t b) const;
+    /* the better of two suffixes, by the words they belong to */
+    uint32_t bestOf(uint32_t a, uint32_t b) const;
+    /* best suffix in suffixes[first, last), which must not be empty */
+    uint32_t bestIn(size_t first, size_t last) const;
+    /* rebuilds the suffix array and the tree over every word */
+    void rebuild();
+
+  public:
+    /* Initializes an index of words, <frequency, word> pairs the caller
+     * keeps distinct. With tokenStartsOnly only the suffixes starting a
+     * space separated token are indexed: "york" still finds
+     * "new york city" but "ork" does not, for a much smaller index
+     **/
+    InfixIndex(const vector<pair<unsigned int, string>>& words =
+                   vector<pair<unsigned int, string>>(),
+               bool tokenStartsOnly = false);
+
+    /* adds a word that is not in the index yet
+     * @return false, and nothing is added, if the word is empty or has
+     * frequency 0
+     **/
+    bool insert(const string& word, unsigned int freq);
+
+    /* the words containing fragment with the highest frequencies
+     * @param fragment, the text the words must contain
+     * @param k, the most words to return
+     * @return up to k word ids, highest frequency first and
+     * alphabetically among equal frequencies, none for ""
+     **/
+    vector<unsigned int> search(const string& fragment, unsigned int k) const;
+
+    /* the word with the given id */
+    string word(unsigned int id) const;
+
+    /* frequency of the word with the given id */
+    unsigned int frequency(unsigned int id) const {
+        return __atomic_load_n(&frequencies[id], __ATOMIC_RELAXED);
+    }
+
+    /* changes the frequency of the word with the given id. Searches
+     * rank the indexed words by the old one until reorder is called
+     **/
+    void setFrequency(unsigned int id, unsigned int freq);
+
+    /* rebuilds the tree over the suffix array from the current
+     * frequencies, in O(number of suffixes)
+     **/
+    void reorder();
+
+    /* true if only token starts are indexed */
+    bool indexesTokenStartsOnly() const { return tokenStartsOnly; }
+
+    /* number of words stored */
+    size_t size() const { return starts.size(); }
+
+    /* bytes held by the words, the suffix array and the tree */
+    size_t sizeInBytes() const;
+};
+
+#endif  // INFIX_INDEX_HPP
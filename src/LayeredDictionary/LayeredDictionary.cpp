@@ -0,0 +1,272 @@
+/**
+ * This file implements the LayeredDictionary
+ * defined in LayeredDictionary.hpp
+ */
+#include "LayeredDictionary.hpp"
+#include <algorithm>
+
+/* orders <frequency, word> pairs by word only */
+static bool byWord(const pair<unsigned int, string>& a,
+                   const pair<unsigned int, string>& b) {
+    return a.second < b.second;
+}
+
+/* median first insertion of sortedWords[first, last) */
+static void insertBalanced(DictionaryTrie& trie,
+                           const vector<pair<unsigned int, string>>& words,
+                           size_t first, size_t last) {
+    if (first >= last) {
+        return;
+    }
+    size_t middle = first + (last - first) / 2;
+    trie.insert(words[middle].second, words[middle].first);
+    insertBalanced(trie, words, first, middle);
+    insertBalanced(trie, words, middle + 1, last);
+}
+
+/**
+ * Layered dictionary constructor
+ * @param words the <frequency, word> pairs of the base
+ * @param mergeThreshold delta size that triggers a merge
+ * @param mergeInterval how often a non empty delta is merged anyway
+ */
+LayeredDictionary::LayeredDictionary(
+    const vector<pair<unsigned int, string>>& words, size_t mergeThreshold,
+    chrono::milliseconds mergeInterval)
+    : delta(new DictionaryTrie()),
+      deltaWords(0),
+      frozenWords(0),
+      numMerges(0),
+      mergeThreshold(max<size_t>(1, mergeThreshold)),
+      mergeInterval(mergeInterval),
+      stopping(false),
+      mergeRequested(false) {
+    vector<pair<unsigned int, string>> sorted;
+    for (unsigned int i = 0; i < words.size(); i++) {
+        if (!words[i].second.empty() && words[i].first > 0) {
+            sorted.push_back(words[i]);
+        }
+    }
+    // stable, so unique keeps the first of the duplicates
+    stable_sort(sorted.begin(), sorted.end(), byWord);
+    sorted.erase(unique(sorted.begin(), sorted.end(),
+                        [](const pair<unsigned int, string>& a,
+                           const pair<unsigned int, string>& b) {
+                            return a.second == b.second;
+                        }),
+                 sorted.end());
+    base.reset(buildBalanced(sorted));
+    baseWords = sorted.size();
+
+    merger = thread(&LayeredDictionary::mergeLoop, this);
+}
+
+/* inserts a new word into the delta
+ * @return true if inserted false if duplicate in any layer
+ **/
+bool LayeredDictionary::insert(string word, unsigned int freq) {
+    bool full;
+    {
+        unique_lock<shared_timed_mutex> guard(layerLock);
+        if (base->find(word) ||
+            (frozenDelta != nullptr && frozenDelta->find(word)) ||
+            !delta->insert(word, freq)) {
+            return false;
+        }
+        full = ++deltaWords >= mergeThreshold;
+    }
+    if (full) {
+        // flagged under the lock, so a merge already running sees it
+        // when it waits again
+        {
+            lock_guard<mutex> guard(wakeLock);
+            mergeRequested = true;
+        }
+        wake.notify_one();
+    }
+    return true;
+}
+
+/* finds a word in the dictionary
+ * @return true if found in any layer false otherwise
+ **/
+bool LayeredDictionary::find(string word) const {
+    return frequency(word) != 0;
+}
+
+/* frequency of a word, 0 if it is not in the dictionary */
+unsigned int LayeredDictionary::frequency(string word) const {
+    shared_ptr<const DictionaryTrie> baseLayer;
+    shared_ptr<const DictionaryTrie> frozenLayer;
+    {
+        shared_lock<shared_timed_mutex> guard(layerLock);
+        unsigned int freq = delta->frequency(word);
+        if (freq != 0) {
+            return freq;
+        }
+        baseLayer = base;
+        frozenLayer = frozenDelta;
+    }
+    unsigned int freq = baseLayer->frequency(word);
+    if (freq == 0 && frozenLayer != nullptr) {
+        freq = frozenLayer->frequency(word);
+    }
+    return freq;
+}
+
+/* DictionaryTrie::predictCompletions over every layer */
+vector<string> LayeredDictionary::predictCompletions(
+    string prefix, unsigned int numCompletions) const {
+    // the layers share no words, so their best completions can be
+    // gathered in one queue
+    WordPQ completions;
+    shared_ptr<const DictionaryTrie> baseLayer;
+    shared_ptr<const DictionaryTrie> frozenLayer;
+    {
+        shared_lock<shared_timed_mutex> guard(layerLock);
+        delta->collectCompletions(prefix, numCompletions, completions);
+        baseLayer = base;
+        frozenLayer = frozenDelta;
+    }
+    baseLayer->collectCompletions(prefix, numCompletions, completions);
+    if (frozenLayer != nullptr) {
+        frozenLayer->collectCompletions(prefix, numCompletions, completions);
+    }
+
+    vector<string> completionSet;
+    while (!completions.empty()) {
+        completionSet.push_back(completions.top().second);
+        completions.pop();
+    }
+    return completionSet;
+}
+
+/* DictionaryTrie::predictUnderscores over every layer */
+vector<string> LayeredDictionary::predictUnderscores(
+    string pattern, unsigned int numCompletions) const {
+    WordPQ completions;
+    shared_ptr<const DictionaryTrie> baseLayer;
+    shared_ptr<const DictionaryTrie> frozenLayer;
+    {
+        shared_lock<shared_timed_mutex> guard(layerLock);
+        delta->collectUnderscores(pattern, numCompletions, completions);
+        baseLayer = base;
+        frozenLayer = frozenDelta;
+    }
+    baseLayer->collectUnderscores(pattern, numCompletions, completions);
+    if (frozenLayer != nullptr) {
+        frozenLayer->collectUnderscores(pattern, numCompletions, completions);
+    }
+
+    vector<string> completionSet;
+    while (!completions.empty()) {
+        completionSet.push_back(completions.top().second);
+        completions.pop();
+    }
+    return completionSet;
+}
+
+/* folds the delta into a new base now, on the calling thread.
+ * Readers and writers keep going while the base is rebuilt
+ * @return false if the delta was empty
+ **/
+bool LayeredDictionary::merge() {
+    lock_guard<mutex> merging(mergeLock);
+
+    // freeze the delta, new inserts go to a fresh one
+    shared_ptr<const DictionaryTrie> oldBase;
+    shared_ptr<const DictionaryTrie> folding;
+    {
+        unique_lock<shared_timed_mutex> guard(layerLock);
+        if (deltaWords == 0) {
+            return false;
+        }
+        frozenDelta.reset(delta.release());
+        delta.reset(new DictionaryTrie());
+        frozenWords = deltaWords;
+        deltaWords = 0;
+        oldBase = base;
+        folding = frozenDelta;
+    }
+
+    // the slow part, no lock held
+    vector<pair<unsigned int, string>> words;
+    vector<pair<unsigned int, string>> newWords;
+    oldBase->collectWords(words);
+    folding->collectWords(newWords);
+    words.insert(words.end(), newWords.begin(), newWords.end());
+    sort(words.begin(), words.end(), byWord);
+    shared_ptr<const DictionaryTrie> newBase(buildBalanced(words));
+
+    // readers still holding the old layers free them when they finish
+    {
+        unique_lock<shared_timed_mutex> guard(layerLock);
+        base = newBase;
+        frozenDelta = nullptr;
+        baseWords = words.size();
+        frozenWords = 0;
+        numMerges++;
+    }
+    return true;
+}
+
+/* number of words in every layer */
+size_t LayeredDictionary::size() const {
+    shared_lock<shared_timed_mutex> guard(layerLock);
+    return baseWords + frozenWords + deltaWords;
+}
+
+/* number of words waiting in the delta layers */
+size_t LayeredDictionary::pendingWords() const {
+    shared_lock<shared_timed_mutex> guard(layerLock);
+    return frozenWords + deltaWords;
+}
+
+/* number of merges done so far */
+unsigned int LayeredDictionary::merges() const {
+    shared_lock<shared_timed_mutex> guard(layerLock);
+    return numMerges;
+}
+
+/* builds a balanced trie from alphabetically sorted, distinct words:
+ * inserting the median first keeps every left/right subtree even
+ **/
+DictionaryTrie* LayeredDictionary::buildBalanced(
+    const vector<pair<unsigned int, string>>& sortedWords) {
+    DictionaryTrie* trie = new DictionaryTrie();
+    insertBalanced(*trie, sortedWords, 0, sortedWords.size());
+    trie->buildIndex();
+    return trie;
+}
+
+/**
+ * Destructor
+ * stops the merge thread, a pending delta is dropped with the rest
+ */
+LayeredDictionary::~LayeredDictionary() {
+    {
+        lock_guard<mutex> guard(wakeLock);
+        stopping = true;
+    }
+    wake.notify_one();
+    merger.join();
+}
+
+/**
+ * Merge Loop
+ * wakes when an insert fills the delta or the interval runs out
+ */
+void LayeredDictionary::mergeLoop() {
+    unique_lock<mutex> guard(wakeLock);
+    while (!stopping) {
+        wake.wait_for(guard, mergeInterval,
+                      [this]() { return stopping || mergeRequested; });
+        if (stopping) {
+            return;
+        }
+        mergeRequested = false;
+        guard.unlock();
+        merge();
+        guard.lock();
+    }
+}
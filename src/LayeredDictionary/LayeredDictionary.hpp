@@ -0,0 +1,117 @@
+/**
+ * This hpp file defines the LayeredDictionary, which keeps a large
+ * frozen DictionaryTrie for reads and a small mutable one for new
+ * words, and folds the small one into a new frozen base in the
+ * background, in the manner of a log structured merge tree
+ */
+#ifndef LAYERED_DICTIONARY_HPP
+#define LAYERED_DICTIONARY_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "DictionaryTrie.hpp"
+
+using namespace std;
+
+/**
+ * A dictionary of up to three layers, no word is in two of them:
+ *  - base, frozen, built balanced with a hash index for find
+ *  - frozen delta, the delta a running merge is folding into base
+ *  - delta, a small DictionaryTrie taking every insert
+ * Readers copy the layer pointers under a shared lock and query the
+ * frozen layers without holding it, so a merge only excludes them
+ * while it swaps the pointers.
+ */
+class LayeredDictionary {
+  private:
+    shared_ptr<const DictionaryTrie> base;
+    shared_ptr<const DictionaryTrie> frozenDelta;  // nullptr unless merging
+    unique_ptr<DictionaryTrie> delta;
+    size_t baseWords;
+    size_t deltaWords;
+    size_t frozenWords;
+    unsigned int numMerges;
+    // guards the layer pointers and the delta itself
+    mutable shared_timed_mutex layerLock;
+
+    // background merging
+    size_t mergeThreshold;
+    chrono::milliseconds mergeInterval;
+    mutex mergeLock;  // one merge at a time
+    mutex wakeLock;
+    condition_variable wake;
+    bool stopping;
+    bool mergeRequested;  // an insert filled the delta, under wakeLock
+    thread merger;
+
+    /* merge thread body */
+    void mergeLoop();
+
+  public:
+    /* Initializes the base from <frequency, word> pairs, the first of
+     * any duplicates is kept. The delta is merged once it holds
+     * mergeThreshold words, or every mergeInterval if it holds any
+     **/
+    LayeredDictionary(const vector<pair<unsigned int, string>>& words,
+                      size_t mergeThreshold = 4096,
+                      chrono::milliseconds mergeInterval =
+                          chrono::milliseconds(1000));
+
+    // owns the merge thread
+    LayeredDictionary(const LayeredDictionary&) = delete;
+    LayeredDictionary& operator=(const LayeredDictionary&) = delete;
+
+    /* inserts a new word into the delta
+     * @return true if inserted false if duplicate in any layer
+     **/
+    bool insert(string word, unsigned int freq);
+
+    /* finds a word in the dictionary
+     * @return true if found in any layer false otherwise
+     **/
+    bool find(string word) const;
+
+    /* frequency of a word, 0 if it is not in the dictionary */
+    unsigned int frequency(string word) const;
+
+    /* DictionaryTrie::predictCompletions over every layer */
+    vector<string> predictCompletions(string prefix,
+                                      unsigned int numCompletions) const;
+
+    /* DictionaryTrie::predictUnderscores over every layer */
+    vector<string> predictUnderscores(string pattern,
+                                      unsigned int numCompletions) const;
+
+    /* folds the delta into a new base now, on the calling thread.
+     * Readers and writers keep going while the base is rebuilt
+     * @return false if the delta was empty
+     **/
+    bool merge();
+
+    /* number of words in every layer */
+    size_t size() const;
+
+    /* number of words waiting in the delta layers */
+    size_t pendingWords() const;
+
+    /* number of merges done so far */
+    unsigned int merges() const;
+
+    /* builds a balanced trie from alphabetically sorted, distinct words:
+     * inserting the median first keeps every left/right subtree even
+     **/
+    static DictionaryTrie* buildBalanced(
+        const vector<pair<unsigned int, string>>& sortedWords);
+
+    /* Destructor, stops the merge thread */
+    ~LayeredDictionary();
+};
+
+#endif  // LAYERED_DICTIONARY_HPP
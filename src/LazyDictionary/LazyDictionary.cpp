@@ -0,0 +1,172 @@
+/**
+ * This file implements the LazyDictionary
+ * defined in LazyDictionary.hpp
+ */
+#include "LazyDictionary.hpp"
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cctype>
+#include <iostream>
+#include <sstream>
+#include "util.hpp"
+
+/* Initializes a dictionary with no file, see open() */
+LazyDictionary::LazyDictionary()
+    : data(nullptr), dataSize(0), numLines(0), numBuilt(0) {}
+
+/* maps a dictionary file and indexes its lines by first letter
+ * @return true on success, false with a message on cerr otherwise
+ **/
+bool LazyDictionary::open(const string& filename) {
+    if (data != nullptr) {
+        cerr << "Dictionary already open" << endl;
+        return false;
+    }
+    int fd = ::open(filename.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        cerr << "open " << filename << ": " << strerror(errno) << endl;
+        return false;
+    }
+    struct stat status;
+    if (fstat(fd, &status) < 0) {
+        cerr << "fstat " << filename << ": " << strerror(errno) << endl;
+        ::close(fd);
+        return false;
+    }
+    if (status.st_size == 0) {
+        cerr << "Cannot map " << filename << ": empty file" << endl;
+        ::close(fd);
+        return false;
+    }
+    void* mapped = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        cerr << "mmap " << filename << ": " << strerror(errno) << endl;
+        return false;
+    }
+    data = (const char*)mapped;
+    dataSize = status.st_size;
+    // the pre-scan reads the file front to back
+    madvise(mapped, dataSize, MADV_SEQUENTIAL);
+
+    // a line is "<frequency> <word>", the word starts at its second token
+    size_t line = 0;
+    while (line < dataSize) {
+        const char* end =
+            (const char*)memchr(data + line, '\n', dataSize - line);
+        size_t next = end == nullptr ? dataSize : end - data + 1;
+        size_t i = line;
+        while (i < next && isspace((unsigned char)data[i])) i++;
+        while (i < next && !isspace((unsigned char)data[i])) i++;
+        while (i < next && isspace((unsigned char)data[i])) i++;
+        if (i < next) {
+            letters[(unsigned char)data[i]].lines.push_back(line);
+        }
+        numLines++;
+        line = next;
+    }
+    madvise(mapped, dataSize, MADV_RANDOM);
+    return true;
+}
+
+/* finds a word in the dictionary
+ * @return true if found false otherwise
+ **/
+bool LazyDictionary::find(string word) const {
+    return frequency(word) != 0;
+}
+
+/* frequency of a word, 0 if it is not in the dictionary */
+unsigned int LazyDictionary::frequency(string word) const {
+    if (word.empty()) {
+        return 0;
+    }
+    const DictionaryTrie* trie = letter(word[0]);
+    return trie == nullptr ? 0 : trie->frequency(word);
+}
+
+/* DictionaryTrie::predictCompletions, builds one letter at most */
+vector<string> LazyDictionary::predictCompletions(
+    string prefix, unsigned int numCompletions) const {
+    if (prefix.empty()) {
+        return vector<string>();
+    }
+    const DictionaryTrie* trie = letter(prefix[0]);
+    return trie == nullptr ? vector<string>()
+                           : trie->predictCompletions(prefix, numCompletions);
+}
+
+/* DictionaryTrie::predictUnderscores, builds every letter if the
+ * pattern starts with an underscore
+ **/
+vector<string> LazyDictionary::predictUnderscores(
+    string pattern, unsigned int numCompletions) const {
+    if (pattern.empty()) {
+        return vector<string>();
+    }
+    if (pattern[0] != '_') {
+        const DictionaryTrie* trie = letter(pattern[0]);
+        return trie == nullptr
+                   ? vector<string>()
+                   : trie->predictUnderscores(pattern, numCompletions);
+    }
+
+    // the letters share no words, so their best matches can be gathered
+    // in one queue
+    WordPQ completions;
+    for (unsigned int first = 0; first < 256; first++) {
+        const DictionaryTrie* trie = letter((char)first);
+        if (trie != nullptr) {
+            trie->collectUnderscores(pattern, numCompletions, completions);
+        }
+    }
+    vector<string> completionSet;
+    while (!completions.empty()) {
+        completionSet.push_back(completions.top().second);
+        completions.pop();
+    }
+    return completionSet;
+}
+
+/* the trie of the words starting with first, built if needed,
+ * nullptr if the file has none
+ **/
+const DictionaryTrie* LazyDictionary::letter(char first) const {
+    Letter& letter = letters[(unsigned char)first];
+    if (letter.lines.empty()) {
+        return nullptr;
+    }
+    call_once(letter.built, [&]() { build(letter); });
+    return letter.trie.get();
+}
+
+/* parses the lines of a letter into its trie */
+void LazyDictionary::build(Letter& letter) const {
+    string text;
+    for (size_t i = 0; i < letter.lines.size(); i++) {
+        size_t line = letter.lines[i];
+        const char* end =
+            (const char*)memchr(data + line, '\n', dataSize - line);
+        text.append(data + line, end == nullptr ? data + dataSize : end + 1);
+        if (end == nullptr) {
+            text.push_back('\n');
+        }
+    }
+    istringstream in(text);
+    letter.trie.reset(new DictionaryTrie());
+    Utils::loadDict(*letter.trie, in);
+    numBuilt++;
+}
+
+/**
+ * Destructor
+ * unmaps the file
+ */
+LazyDictionary::~LazyDictionary() {
+    if (data != nullptr) {
+        munmap((void*)data, dataSize);
+    }
+}
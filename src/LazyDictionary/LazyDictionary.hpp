@@ -0,0 +1,91 @@
+/**
+ * This hpp file defines the LazyDictionary, a dictionary file that is
+ * only indexed when opened: one quick pass records where the lines of
+ * every first letter are, and the DictionaryTrie of a letter is built
+ * the first time a query needs it. Tools that only ask about a few
+ * letters never pay for the rest of the file.
+ */
+#ifndef LAZY_DICTIONARY_HPP
+#define LAZY_DICTIONARY_HPP
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "DictionaryTrie.hpp"
+
+using namespace std;
+
+/**
+ * The file is mapped into memory, so building a letter reads only the
+ * pages holding its lines. Every letter is built at most once, by the
+ * first query to touch it, while concurrent queries on the same letter
+ * wait for it; queries on letters already built never wait. Words are
+ * parsed as Utils::loadDict parses them, and the first of any
+ * duplicates is kept.
+ */
+class LazyDictionary {
+  private:
+    /* the words starting with one byte */
+    struct Letter {
+        vector<size_t> lines;  // file offset of every line, in file order
+        once_flag built;
+        unique_ptr<DictionaryTrie> trie;
+    };
+
+    const char* data;  // the mapped file
+    size_t dataSize;
+    size_t numLines;
+    mutable Letter letters[256];
+    mutable atomic<unsigned int> numBuilt;
+
+    /* the trie of the words starting with first, built if needed,
+     * nullptr if the file has none
+     **/
+    const DictionaryTrie* letter(char first) const;
+    /* parses the lines of a letter into its trie */
+    void build(Letter& letter) const;
+
+  public:
+    /* Initializes a dictionary with no file, see open() */
+    LazyDictionary();
+
+    // owns a memory mapping
+    LazyDictionary(const LazyDictionary&) = delete;
+    LazyDictionary& operator=(const LazyDictionary&) = delete;
+
+    /* maps a dictionary file and indexes its lines by first letter
+     * @return true on success, false with a message on cerr otherwise
+     **/
+    bool open(const string& filename);
+
+    /* finds a word in the dictionary
+     * @return true if found false otherwise
+     **/
+    bool find(string word) const;
+
+    /* frequency of a word, 0 if it is not in the dictionary */
+    unsigned int frequency(string word) const;
+
+    /* DictionaryTrie::predictCompletions, builds one letter at most */
+    vector<string> predictCompletions(string prefix,
+                                      unsigned int numCompletions) const;
+
+    /* DictionaryTrie::predictUnderscores, builds every letter if the
+     * pattern starts with an underscore
+     **/
+    vector<string> predictUnderscores(string pattern,
+                                      unsigned int numCompletions) const;
+
+    /* number of lines in the file */
+    size_t lines() const { return numLines; }
+
+    /* number of letters whose trie has been built */
+    unsigned int builtLetters() const { return numBuilt; }
+
+    /* Destructor, unmaps the file */
+    ~LazyDictionary();
+};
+
+#endif  // LAZY_DICTIONARY_HPP
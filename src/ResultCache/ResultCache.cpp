@@ -0,0 +1,259 @@
+/**
+ * This file implements the ResultCache and CachedDictionary
+ * defined in ResultCache.hpp
+ */
+#include "ResultCache.hpp"
+#include <functional>
+
+/**
+ * Cache constructor
+ * @param capacity the maximum number of cached results
+ * @param numShards the number of independently locked shards
+ */
+ResultCache::ResultCache(unsigned int capacity, unsigned int numShards)
+    : shards(numShards == 0 ? 1 : numShards),
+      hitCount(0),
+      missCount(0),
+      invalidationCount(0) {
+    // round up so the shards hold at least capacity results together
+    for (unsigned int i = 0; i < shards.size(); i++) {
+        shards[i].capacity = (capacity + shards.size() - 1) / shards.size();
+    }
+}
+
+/* looks up a cached result
+ * @return true and fills results on a hit, false on a miss
+ **/
+bool ResultCache::get(QueryType type, const string& query,
+                      unsigned int numCompletions, vector<string>& results) {
+    string queryKey = makeQueryKey(type, query);
+    string key = queryKey + '\0' + to_string(numCompletions);
+    Shard& shard = shardFor(queryKey);
+
+    lock_guard<mutex> guard(shard.lock);
+    auto found = shard.entries.find(key);
+    if (found == shard.entries.end()) {
+        missCount++;
+        return false;
+    }
+
+    // move the entry to the front of the LRU list
+    shard.lru.splice(shard.lru.begin(), shard.lru, found->second);
+    results = found->second->results;
+    hitCount++;
+    return true;
+}
+
+/* caches a result, evicting the least recently used of its shard */
+void ResultCache::put(QueryType type, const string& query,
+                      unsigned int numCompletions,
+                      const vector<string>& results) {
+    string queryKey = makeQueryKey(type, query);
+    string key = queryKey + '\0' + to_string(numCompletions);
+    Shard& shard = shardFor(queryKey);
+
+    lock_guard<mutex> guard(shard.lock);
+    if (shard.capacity == 0) {
+        return;
+    }
+
+    auto found = shard.entries.find(key);
+    if (found != shard.entries.end()) {  // another thread got here first
+        found->second->results = results;
+        shard.lru.splice(shard.lru.begin(), shard.lru, found->second);
+        return;
+    }
+
+    if (shard.lru.size() >= shard.capacity) {
+        eraseEntry(shard, prev(shard.lru.end()));
+    }
+
+    shard.lru.push_front(CacheEntry{key, queryKey, numCompletions, results});
+    shard.entries[key] = shard.lru.begin();
+    shard.queryKeys[queryKey].insert(numCompletions);
+    if (type == PATTERN_QUERY) {
+        shard.patterns[query.length()].insert(query);
+    }
+}
+
+/* drops every result that inserting or changing the frequency of
+ * word could change: completions of its prefixes and patterns
+ * of its length that match it
+ **/
+void ResultCache::invalidate(const string& word) {
+    // the word is a completion of each of its prefixes
+    for (unsigned int length = 1; length <= word.length(); length++) {
+        string queryKey = makeQueryKey(PREFIX_QUERY, word.substr(0, length));
+        Shard& shard = shardFor(queryKey);
+        lock_guard<mutex> guard(shard.lock);
+        eraseQuery(shard, queryKey);
+    }
+
+    // patterns only match words of their own length
+    for (unsigned int i = 0; i < shards.size(); i++) {
+        Shard& shard = shards[i];
+        lock_guard<mutex> guard(shard.lock);
+
+        auto found = shard.patterns.find(word.length());
+        if (found == shard.patterns.end()) {
+            continue;
+        }
+
+        vector<string> matches;
+        for (const string& pattern : found->second) {
+            unsigned int index = 0;
+            while (index < word.length() &&
+                   (pattern[index] == '_' || pattern[index] == word[index])) {
+                index++;
+            }
+            if (index == word.length()) {
+                matches.push_back(pattern);
+            }
+        }
+        for (unsigned int j = 0; j < matches.size(); j++) {
+            eraseQuery(shard, makeQueryKey(PATTERN_QUERY, matches[j]));
+        }
+    }
+}
+
+/* drops every cached result */
+void ResultCache::clear() {
+    for (unsigned int i = 0; i < shards.size(); i++) {
+        lock_guard<mutex> guard(shards[i].lock);
+        shards[i].lru.clear();
+        shards[i].entries.clear();
+        shards[i].queryKeys.clear();
+        shards[i].patterns.clear();
+    }
+}
+
+/* number of cached results */
+size_t ResultCache::size() {
+    size_t total = 0;
+    for (unsigned int i = 0; i < shards.size(); i++) {
+        lock_guard<mutex> guard(shards[i].lock);
+        total += shards[i].lru.size();
+    }
+    return total;
+}
+
+/* fraction of lookups that were hits */
+double ResultCache::hitRate() const {
+    unsigned long long lookups = hitCount + missCount;
+    return lookups == 0 ? 0.0 : (double)hitCount / lookups;
+}
+
+/**
+ * Key Helper
+ * prefixes and patterns with the same text must not share entries
+ */
+string ResultCache::makeQueryKey(QueryType type, const string& query) {
+    return (type == PREFIX_QUERY ? "c" : "u") + query;
+}
+
+/**
+ * Shard Helper
+ * hashes the query key so every numCompletions of a query
+ * lives in the same shard
+ */
+ResultCache::Shard& ResultCache::shardFor(const string& queryKey) {
+    return shards[hash<string>()(queryKey) % shards.size()];
+}
+
+/**
+ * Erase Helper
+ * removes an entry from the LRU list and every index
+ */
+void ResultCache::eraseEntry(Shard& shard, list<CacheEntry>::iterator entry) {
+    auto numCompletions = shard.queryKeys.find(entry->queryKey);
+    numCompletions->second.erase(entry->numCompletions);
+
+    if (numCompletions->second.empty()) {
+        shard.queryKeys.erase(numCompletions);
+        if (entry->queryKey[0] == 'u') {  // last entry of a pattern
+            string pattern = entry->queryKey.substr(1);
+            shard.patterns[pattern.length()].erase(pattern);
+        }
+    }
+
+    shard.entries.erase(entry->key);
+    shard.lru.erase(entry);
+}
+
+/**
+ * Query Erase Helper
+ * removes the entries of every numCompletions cached for a query
+ */
+void ResultCache::eraseQuery(Shard& shard, const string& queryKey) {
+    auto found = shard.queryKeys.find(queryKey);
+    if (found == shard.queryKeys.end()) {
+        return;
+    }
+
+    // copy, eraseEntry removes from the set we would be iterating
+    set<unsigned int> numCompletions = found->second;
+    for (unsigned int k : numCompletions) {
+        eraseEntry(shard, shard.entries[queryKey + '\0' + to_string(k)]);
+        invalidationCount++;
+    }
+}
+
+/**
+ * CachedDictionary constructor
+ * @param dict the dictionary to answer misses from
+ * @param capacity the maximum number of cached results
+ */
+CachedDictionary::CachedDictionary(DictionaryTrie& dict,
+                                   unsigned int capacity)
+    : dict(dict), cache(capacity) {}
+
+/* inserts a new word and invalidates the results it changes
+ * @return true if inserted false if duplicate
+ **/
+bool CachedDictionary::insert(string word, unsigned int freq) {
+    // no query may compute or store a result while the trie changes
+    unique_lock<shared_timed_mutex> guard(trieLock);
+    if (!dict.insert(word, freq)) {
+        return false;
+    }
+    cache.invalidate(word);
+    return true;
+}
+
+/* finds a word in the dictionary, never cached */
+bool CachedDictionary::find(string word) const {
+    shared_lock<shared_timed_mutex> guard(trieLock);
+    return dict.find(word);
+}
+
+/* cached DictionaryTrie::predictCompletions */
+vector<string> CachedDictionary::predictCompletions(
+    string prefix, unsigned int numCompletions) {
+    vector<string> completionSet;
+    shared_lock<shared_timed_mutex> guard(trieLock);
+
+    if (!cache.get(PREFIX_QUERY, prefix, numCompletions, completionSet)) {
+        completionSet = dict.predictCompletions(prefix, numCompletions);
+        cache.put(PREFIX_QUERY, prefix, numCompletions, completionSet);
+    }
+    return completionSet;
+}
+
+/* cached DictionaryTrie::predictUnderscores */
+vector<string> CachedDictionary::predictUnderscores(
+    string pattern, unsigned int numCompletions) {
+    vector<string> completionSet;
+    shared_lock<shared_timed_mutex> guard(trieLock);
+
+    if (!cache.get(PATTERN_QUERY, pattern, numCompletions, completionSet)) {
+        completionSet = dict.predictUnderscores(pattern, numCompletions);
+        cache.put(PATTERN_QUERY, pattern, numCompletions, completionSet);
+    }
+    return completionSet;
+}
+
+/* invalidates the results of a word whose frequency changed */
+void CachedDictionary::invalidate(const string& word) {
+    unique_lock<shared_timed_mutex> guard(trieLock);
+    cache.invalidate(word);
+}
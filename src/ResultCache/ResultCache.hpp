@@ -0,0 +1,140 @@
+/**
+ * This hpp file defines the ResultCache, a bounded LRU cache of
+ * query results keyed by (query, numCompletions), and the
+ * CachedDictionary which puts a ResultCache in front of the
+ * prediction functions of a DictionaryTrie
+ */
+#ifndef RESULT_CACHE_HPP
+#define RESULT_CACHE_HPP
+
+#include <atomic>
+#include <list>
+#include <mutex>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "DictionaryTrie.hpp"
+
+using namespace std;
+
+/* the prediction function a cached result came from */
+enum QueryType { PREFIX_QUERY, PATTERN_QUERY };
+
+/**
+ * A thread safe LRU cache of query results. Entries are spread
+ * over shards that each have their own lock and LRU list, and
+ * every entry can be dropped by the word whose insertion would
+ * change its result.
+ */
+class ResultCache {
+  private:
+    /* one cached result */
+    struct CacheEntry {
+        string key;       // full key: type, query and numCompletions
+        string queryKey;  // type and query, shared by every numCompletions
+        unsigned int numCompletions;
+        vector<string> results;
+    };
+
+    /* an independently locked part of the cache */
+    struct Shard {
+        mutex lock;
+        unsigned int capacity;
+        list<CacheEntry> lru;  // most recently used at the front
+        unordered_map<string, list<CacheEntry>::iterator> entries;
+        // every numCompletions cached for a query key
+        unordered_map<string, set<unsigned int>> queryKeys;
+        // cached underscore patterns by length
+        unordered_map<size_t, set<string>> patterns;
+    };
+
+    vector<Shard> shards;
+    atomic<unsigned long long> hitCount;
+    atomic<unsigned long long> missCount;
+    atomic<unsigned long long> invalidationCount;
+
+    /* builds the key shared by every numCompletions of a query */
+    static string makeQueryKey(QueryType type, const string& query);
+    /* picks the shard holding every entry of a query key */
+    Shard& shardFor(const string& queryKey);
+    /* removes a single entry, caller holds the shard lock */
+    void eraseEntry(Shard& shard, list<CacheEntry>::iterator entry);
+    /* removes every entry of a query key, caller holds the shard lock */
+    void eraseQuery(Shard& shard, const string& queryKey);
+
+  public:
+    /* Initializes a cache holding at most capacity results */
+    ResultCache(unsigned int capacity, unsigned int numShards = 16);
+
+    /* looks up a cached result
+     * @return true and fills results on a hit, false on a miss
+     **/
+    bool get(QueryType type, const string& query,
+             unsigned int numCompletions, vector<string>& results);
+
+    /* caches a result, evicting the least recently used of its shard */
+    void put(QueryType type, const string& query, unsigned int numCompletions,
+             const vector<string>& results);
+
+    /* drops every result that inserting or changing the frequency of
+     * word could change: completions of its prefixes and patterns
+     * of its length that match it
+     **/
+    void invalidate(const string& word);
+
+    /* drops every cached result */
+    void clear();
+
+    /* number of cached results */
+    size_t size();
+
+    unsigned long long hits() const { return hitCount; }
+    unsigned long long misses() const { return missCount; }
+    unsigned long long invalidations() const { return invalidationCount; }
+
+    /* fraction of lookups that were hits */
+    double hitRate() const;
+};
+
+/**
+ * A DictionaryTrie behind a ResultCache. Queries may run from many
+ * threads at once, inserts wait for running queries and invalidate
+ * only the cached results they affect.
+ */
+class CachedDictionary {
+  private:
+    DictionaryTrie& dict;
+    ResultCache cache;
+    // queries share the trie, inserts take it exclusively
+    mutable shared_timed_mutex trieLock;
+
+  public:
+    /* Initializes a cache of capacity results in front of dict */
+    CachedDictionary(DictionaryTrie& dict, unsigned int capacity);
+
+    /* inserts a new word and invalidates the results it changes
+     * @return true if inserted false if duplicate
+     **/
+    bool insert(string word, unsigned int freq);
+
+    /* finds a word in the dictionary, never cached */
+    bool find(string word) const;
+
+    /* cached DictionaryTrie::predictCompletions */
+    vector<string> predictCompletions(string prefix,
+                                      unsigned int numCompletions);
+
+    /* cached DictionaryTrie::predictUnderscores */
+    vector<string> predictUnderscores(string pattern,
+                                      unsigned int numCompletions);
+
+    /* invalidates the results of a word whose frequency changed */
+    void invalidate(const string& word);
+
+    /* the cache, for hit rate counters */
+    ResultCache& getCache() { return cache; }
+};
+
+#endif  // RESULT_CACHE_HPP
@@ -0,0 +1,159 @@
+/**
+ * This file implements the ShardedDictionary
+ * defined in ShardedDictionary.hpp
+ */
+#include "ShardedDictionary.hpp"
+#include <future>
+
+/* number of values a char can take */
+static const unsigned int NUM_CHARS = 256;
+
+/**
+ * Round robin constructor
+ * @param numShards the number of independent tries
+ */
+ShardedDictionary::ShardedDictionary(unsigned int numShards)
+    : shardOf(NUM_CHARS) {
+    if (numShards == 0) {
+        numShards = 1;
+    }
+    for (unsigned int i = 0; i < numShards; i++) {
+        shards.push_back(new DictionaryTrie());
+    }
+    for (unsigned int c = 0; c < NUM_CHARS; c++) {
+        shardOf[c] = c % numShards;
+    }
+}
+
+/**
+ * Balanced constructor
+ * @param numShards the number of independent tries
+ * @param sample <frequency, word> pairs used to size the ranges
+ */
+ShardedDictionary::ShardedDictionary(
+    unsigned int numShards, const vector<pair<unsigned int, string>>& sample)
+    : ShardedDictionary(numShards) {
+    vector<unsigned long long> counts(NUM_CHARS, 0);
+    for (unsigned int i = 0; i < sample.size(); i++) {
+        if (!sample[i].second.empty()) {
+            counts[(unsigned char)sample[i].second[0]]++;
+        }
+    }
+
+    // walk the characters in order, moving to the next shard once the
+    // current one holds its share of the words
+    unsigned long long total = sample.size();
+    unsigned long long seen = 0;
+    unsigned int shard = 0;
+    for (unsigned int c = 0; c < NUM_CHARS; c++) {
+        shardOf[c] = shard;
+        seen += counts[c];
+        if (shard + 1 < shards.size() &&
+            seen * shards.size() >= total * (shard + 1)) {
+            shard++;
+        }
+    }
+}
+
+/* inserts a new word into the shard of its first letter
+ * @return true if inserted false if duplicate
+ **/
+bool ShardedDictionary::insert(string word, unsigned int freq) {
+    if (word.length() == 0) {
+        return false;
+    }
+    return shardFor(word[0])->insert(word, freq);
+}
+
+/* finds a word in the shard of its first letter
+ * @return true if found false otherwise
+ **/
+bool ShardedDictionary::find(string word) const {
+    if (word.length() == 0) {
+        return false;
+    }
+    return shardFor(word[0])->find(word);
+}
+
+/* predicts words given a prefix based on words with
+ * the highest frequencies, only the prefix's shard is searched
+ * @return a vector of suggested completions, same order as
+ * DictionaryTrie::predictCompletions
+ **/
+vector<string> ShardedDictionary::predictCompletions(
+    string prefix, unsigned int numCompletions) const {
+    if (prefix.length() == 0) {
+        return vector<string>();
+    }
+    return shardFor(prefix[0])->predictCompletions(prefix, numCompletions);
+}
+
+/* predicts words given a pattern with underscores, a leading
+ * underscore searches every shard in parallel
+ * @return a vector of suggested completions, same order as
+ * DictionaryTrie::predictUnderscores. When more words tie at the
+ * lowest frequency returned than there is room for, the merge keeps
+ * the alphabetically first, where a single trie keeps the first it
+ * reached, so the words returned may differ
+ **/
+vector<string> ShardedDictionary::predictUnderscores(
+    string pattern, unsigned int numCompletions) const {
+    vector<string> completionSet;
+    if (numCompletions <= 0 || pattern.length() == 0) {
+        return completionSet;
+    }
+    if (pattern[0] != '_') {  // only one shard can match
+        return shardFor(pattern[0])->predictUnderscores(pattern,
+                                                        numCompletions);
+    }
+
+    // every shard fills its own queue on its own thread
+    vector<WordPQ> shardPQs(shards.size());
+    vector<future<void>> searches;
+    for (unsigned int i = 1; i < shards.size(); i++) {
+        searches.push_back(async(launch::async, [&, i]() {
+            shards[i]->collectUnderscores(pattern, numCompletions,
+                                          shardPQs[i]);
+        }));
+    }
+    shards[0]->collectUnderscores(pattern, numCompletions, shardPQs[0]);
+    for (unsigned int i = 0; i < searches.size(); i++) {
+        searches[i].get();
+    }
+
+    // merge, dropping the lowest ranked word whenever there are too many
+    WordPQ merged;
+    for (unsigned int i = 0; i < shardPQs.size(); i++) {
+        while (!shardPQs[i].empty()) {
+            merged.push(shardPQs[i].top());
+            shardPQs[i].pop();
+            if (merged.size() > numCompletions) {
+                merged.pop();
+            }
+        }
+    }
+
+    while (!merged.empty()) {
+        completionSet.push_back(merged.top().second);
+        merged.pop();
+    }
+    return completionSet;
+}
+
+/**
+ * Destructor
+ * deletes every shard
+ */
+ShardedDictionary::~ShardedDictionary() {
+    for (unsigned int i = 0; i < shards.size(); i++) {
+        delete shards[i];
+    }
+}
+
+/**
+ * Shard Helper
+ * looks up the shard of a leading character
+ */
+DictionaryTrie* ShardedDictionary::shardFor(char c) const {
+    return shards[shardOf[(unsigned char)c]];
+}
@@ -0,0 +1,88 @@
+/**
+ * This hpp file defines the ShardedDictionary, a dictionary
+ * split by the first letter of each word into independent
+ * DictionaryTries that can be searched in parallel
+ */
+#ifndef SHARDED_DICTIONARY_HPP
+#define SHARDED_DICTIONARY_HPP
+
+#include <string>
+#include <utility>
+#include <vector>
+#include "DictionaryTrie.hpp"
+
+using namespace std;
+
+/**
+ * A dictionary partitioned into shards by leading character.
+ * Prefix queries only touch the shard of their first letter,
+ * patterns starting with an underscore search every shard in
+ * parallel and the per-shard results are merged in
+ * wordComparator order, which breaks ties alphabetically.
+ */
+class ShardedDictionary {
+  private:
+    vector<DictionaryTrie*> shards;
+    // shard index for every leading character
+    vector<unsigned int> shardOf;
+
+    /* shard holding the words that start with c */
+    DictionaryTrie* shardFor(char c) const;
+
+  public:
+    /* Initializes numShards empty shards, leading characters are
+     * spread over the shards round robin
+     **/
+    ShardedDictionary(unsigned int numShards);
+
+    /* Initializes numShards empty shards, each covering a range of
+     * leading characters holding about the same number of the
+     * given <frequency, word> pairs
+     **/
+    ShardedDictionary(unsigned int numShards,
+                      const vector<pair<unsigned int, string>>& sample);
+
+    // shards are owned, copying would delete them twice
+    ShardedDictionary(const ShardedDictionary&) = delete;
+    ShardedDictionary& operator=(const ShardedDictionary&) = delete;
+
+    /* inserts a new word into the shard of its first letter
+     * @return true if inserted false if duplicate
+     **/
+    bool insert(string word, unsigned int freq);
+
+    /* finds a word in the shard of its first letter
+     * @return true if found false otherwise
+     **/
+    bool find(string word) const;
+
+    /* predicts words given a prefix based on words with
+     * the highest frequencies, only the prefix's shard is searched
+     * @return a vector of suggested completions, same order as
+     * DictionaryTrie::predictCompletions
+     **/
+    vector<string> predictCompletions(string prefix,
+                                      unsigned int numCompletions) const;
+
+    /* predicts words given a pattern with underscores, a leading
+     * underscore searches every shard in parallel
+     * @return a vector of suggested completions, same order as
+     * DictionaryTrie::predictUnderscores. When more words tie at the
+     * lowest frequency returned than there is room for, the merge keeps
+     * the alphabetically first, where a single trie keeps the first it
+     * reached, so the words returned may differ
+     **/
+    vector<string> predictUnderscores(string pattern,
+                                      unsigned int numCompletions) const;
+
+    /* number of shards */
+    unsigned int numShards() const { return shards.size(); }
+
+    /* the i-th shard, for stats */
+    const DictionaryTrie& shard(unsigned int i) const { return *shards[i]; }
+
+    /* Destructor, deletes every shard */
+    ~ShardedDictionary();
+};
+
+#endif  // SHARDED_DICTIONARY_HPP
@@ -0,0 +1,216 @@
+/**
+ * This file implements the SortedArrayDictionary
+ * defined in SortedArrayDictionary.hpp
+ */
+#include "SortedArrayDictionary.hpp"
+#include <algorithm>
+#include <iterator>
+
+/* new words are merged into the main array once there are more than
+ * this many of them and their square is more than the array's size
+ */
+static const size_t MIN_RECENT = 64;
+
+/* true if entry a sorts before entry b */
+static bool wordBefore(const pair<string, unsigned int>& a,
+                       const pair<string, unsigned int>& b) {
+    return a.first < b.first;
+}
+
+/* keeps <freq, word> in completions if it is among the best
+ * numCompletions seen so far, as DictionaryTrie does
+ */
+static void offer(WordPQ& completions, unsigned int numCompletions,
+                  unsigned int freq, const string& word) {
+    if (completions.size() < numCompletions) {
+        completions.push(pair<int, string>(freq, word));
+    } else if (completions.top().first < (int)freq) {
+        completions.pop();
+        completions.push(pair<int, string>(freq, word));
+    }
+}
+
+/* true if word matches pattern, where '_' matches any character */
+static bool matches(const string& pattern, const string& word) {
+    if (pattern.length() != word.length()) {
+        return false;
+    }
+    for (unsigned int i = 0; i < pattern.length(); i++) {
+        if (pattern[i] != '_' && pattern[i] != word[i]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* the words of a drained queue, lowest ranked first */
+static vector<string> drain(WordPQ& completions) {
+    vector<string> completionSet;
+    while (!completions.empty()) {
+        completionSet.push_back(completions.top().second);
+        completions.pop();
+    }
+    return completionSet;
+}
+
+/* Initializes an empty dictionary */
+SortedArrayDictionary::SortedArrayDictionary() {}
+
+/* inserts a new word into the dictionary
+ * @return true if inserted false if empty, frequency 0 or duplicate
+ **/
+bool SortedArrayDictionary::insert(string word, unsigned int freq) {
+    if (word.length() == 0 || freq == 0) {
+        return false;
+    }
+    vector<Entry>::const_iterator found = lowerBound(words, word);
+    if (found != words.end() && found->first == word) {
+        return false;
+    }
+    found = lowerBound(recent, word);
+    if (found != recent.end() && found->first == word) {
+        return false;
+    }
+    recent.insert(recent.begin() + (found - recent.begin()),
+                  Entry(word, freq));
+
+    if (recent.size() > MIN_RECENT &&
+        recent.size() * recent.size() > words.size()) {
+        merge();
+    }
+    return true;
+}
+
+/* inserts <frequency, word> pairs with one sort and one merge
+ * @return the number of words inserted
+ **/
+size_t SortedArrayDictionary::insertAll(
+    const vector<pair<unsigned int, string>>& newWords) {
+    if (!recent.empty()) {
+        merge();
+    }
+    size_t old = words.size();
+    for (size_t i = 0; i < newWords.size(); i++) {
+        if (!newWords[i].second.empty() && newWords[i].first > 0) {
+            words.push_back(Entry(newWords[i].second, newWords[i].first));
+        }
+    }
+
+    // stable, so the first of equal words stays first and is kept
+    vector<Entry>::iterator added = words.begin() + old;
+    stable_sort(added, words.end(), wordBefore);
+    vector<Entry>::iterator last =
+        unique(added, words.end(), [](const Entry& a, const Entry& b) {
+            return a.first == b.first;
+        });
+    const vector<Entry>::iterator existingEnd = added;
+    last = remove_if(added, last, [&](const Entry& entry) {
+        vector<Entry>::iterator found =
+            lower_bound(words.begin(), existingEnd, entry, wordBefore);
+        return found != existingEnd && found->first == entry.first;
+    });
+    words.erase(last, words.end());
+
+    inplace_merge(words.begin(), words.begin() + old, words.end(),
+                  wordBefore);
+    return words.size() - old;
+}
+
+/* finds a word in the dictionary
+ * @return true if found false otherwise
+ **/
+bool SortedArrayDictionary::find(string word) const {
+    return frequency(word) != 0;
+}
+
+/* frequency of a word, 0 if it is not in the dictionary */
+unsigned int SortedArrayDictionary::frequency(string word) const {
+    const vector<Entry>* arrays[] = {&words, &recent};
+    for (const vector<Entry>* entries : arrays) {
+        vector<Entry>::const_iterator found = lowerBound(*entries, word);
+        if (found != entries->end() && found->first == word) {
+            return found->second;
+        }
+    }
+    return 0;
+}
+
+/* DictionaryTrie::predictCompletions, looks at every word starting
+ * with prefix
+ **/
+vector<string> SortedArrayDictionary::predictCompletions(
+    string prefix, unsigned int numCompletions) const {
+    WordPQ completions;
+    if (numCompletions == 0 || prefix == "") {
+        return drain(completions);
+    }
+
+    const vector<Entry>* arrays[] = {&words, &recent};
+    for (const vector<Entry>* entries : arrays) {
+        auto range = prefixRange(*entries, prefix);
+        for (auto entry = range.first; entry != range.second; entry++) {
+            offer(completions, numCompletions, entry->second, entry->first);
+        }
+    }
+    return drain(completions);
+}
+
+/* DictionaryTrie::predictUnderscores, looks at every word starting
+ * with the letters of pattern before its first underscore
+ **/
+vector<string> SortedArrayDictionary::predictUnderscores(
+    string pattern, unsigned int numCompletions) const {
+    WordPQ completions;
+    if (numCompletions == 0 || pattern == "") {
+        return drain(completions);
+    }
+
+    string prefix = pattern.substr(0, pattern.find('_'));
+    const vector<Entry>* arrays[] = {&words, &recent};
+    for (const vector<Entry>* entries : arrays) {
+        auto range = prefixRange(*entries, prefix);
+        for (auto entry = range.first; entry != range.second; entry++) {
+            if (matches(pattern, entry->first)) {
+                offer(completions, numCompletions, entry->second,
+                      entry->first);
+            }
+        }
+    }
+    return drain(completions);
+}
+
+/* the first entry of a sorted array not before word */
+vector<SortedArrayDictionary::Entry>::const_iterator
+SortedArrayDictionary::lowerBound(const vector<Entry>& entries,
+                                  const string& word) {
+    return lower_bound(entries.begin(), entries.end(), Entry(word, 0),
+                       wordBefore);
+}
+
+/* the entries of a sorted array starting with prefix */
+pair<vector<SortedArrayDictionary::Entry>::const_iterator,
+     vector<SortedArrayDictionary::Entry>::const_iterator>
+SortedArrayDictionary::prefixRange(const vector<Entry>& entries,
+                                   const string& prefix) {
+    vector<Entry>::const_iterator first = lowerBound(entries, prefix);
+    // past the range every word compares greater on its first letters
+    vector<Entry>::const_iterator last = upper_bound(
+        first, entries.end(), prefix,
+        [](const string& prefix, const Entry& entry) {
+            return entry.first.compare(0, prefix.length(), prefix) > 0;
+        });
+    return make_pair(first, last);
+}
+
+/* moves recent into words */
+void SortedArrayDictionary::merge() {
+    vector<Entry> merged;
+    merged.reserve(size());
+    std::merge(make_move_iterator(words.begin()),
+               make_move_iterator(words.end()),
+               make_move_iterator(recent.begin()),
+               make_move_iterator(recent.end()), back_inserter(merged),
+               wordBefore);
+    words.swap(merged);
+    recent.clear();
+}
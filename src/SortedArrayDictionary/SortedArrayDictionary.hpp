@@ -0,0 +1,82 @@
+/**
+ * This hpp file defines the SortedArrayDictionary, the simplest
+ * DictionaryEngine worth comparing the trie against: the words in one
+ * sorted array, searched by binary search
+ */
+#ifndef SORTED_ARRAY_DICTIONARY_HPP
+#define SORTED_ARRAY_DICTIONARY_HPP
+
+#include <string>
+#include <utility>
+#include <vector>
+#include "DictionaryEngine.hpp"
+
+using namespace std;
+
+/**
+ * The words starting with a prefix form one range of the sorted array,
+ * found with two binary searches, and the best of them are picked by
+ * looking at every word of the range. A pattern is matched against the
+ * words of the range of its letters before the first underscore, which
+ * is the whole array if it starts with one.
+ * Inserting into the middle of a large array moves half of it, so new
+ * words go to a second, short sorted array, merged into the first once
+ * it holds more than about the square root of its size. Queries look
+ * in both. Loading a whole dictionary goes through insertAll instead,
+ * which sorts the words once.
+ */
+class SortedArrayDictionary : public DictionaryEngine {
+  private:
+    typedef pair<string, unsigned int> Entry;  // <word, frequency>
+
+    vector<Entry> words;   // sorted by word
+    vector<Entry> recent;  // newest words, sorted by word
+
+    /* the first entry of a sorted array not before word */
+    static vector<Entry>::const_iterator lowerBound(
+        const vector<Entry>& entries, const string& word);
+    /* the entries of a sorted array starting with prefix */
+    static pair<vector<Entry>::const_iterator, vector<Entry>::const_iterator>
+    prefixRange(const vector<Entry>& entries, const string& prefix);
+    /* moves recent into words */
+    void merge();
+
+  public:
+    /* Initializes an empty dictionary */
+    SortedArrayDictionary();
+
+    /* inserts a new word into the dictionary
+     * @return true if inserted false if empty, frequency 0 or duplicate
+     **/
+    bool insert(string word, unsigned int freq);
+
+    /* inserts <frequency, word> pairs with one sort and one merge
+     * @return the number of words inserted
+     **/
+    size_t insertAll(const vector<pair<unsigned int, string>>& newWords);
+
+    /* finds a word in the dictionary
+     * @return true if found false otherwise
+     **/
+    bool find(string word) const;
+
+    /* frequency of a word, 0 if it is not in the dictionary */
+    unsigned int frequency(string word) const;
+
+    /* DictionaryTrie::predictCompletions, looks at every word starting
+     * with prefix
+     **/
+    vector<string> predictCompletions(string prefix,
+                                      unsigned int numCompletions) const;
+
+    /* DictionaryTrie::predictUnderscores, looks at every word starting
+     * with the letters of pattern before its first underscore
+     **/
+    vector<string> predictUnderscores(string pattern,
+                                      unsigned int numCompletions) const;
+
+    /* number of words stored */
+    size_t size() const { return words.size() + recent.size(); }
+};
+
+#endif  // SORTED_ARRAY_DICTIONARY_HPP
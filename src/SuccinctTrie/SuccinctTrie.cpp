@@ -0,0 +1,335 @@
+/**
+ * This file implements the BitVector, PackedArray and SuccinctTrie
+ * defined in SuccinctTrie.hpp
+ */
+#include "SuccinctTrie.hpp"
+#include <algorithm>
+#include <cmath>
+#include <queue>
+#include <tuple>
+
+/* bits per rank directory block */
+static const size_t BLOCK_BITS = 512;
+static const size_t WORDS_PER_BLOCK = BLOCK_BITS / 64;
+/* quantization steps per doubling of frequency */
+static const double STEPS_PER_DOUBLING = 7.0;
+
+/* Initializes an empty bit vector */
+BitVector::BitVector() : numBits(0), numOnes(0) {}
+
+/* appends a bit, rank and select need build() afterwards */
+void BitVector::push_back(bool bit) {
+    if (numBits % 64 == 0) {
+        bits.push_back(0);
+    }
+    if (bit) {
+        bits.back() |= (uint64_t)1 << (numBits % 64);
+        numOnes++;
+    }
+    numBits++;
+}
+
+/* precomputes the rank directory */
+void BitVector::build() {
+    blockRanks.clear();
+    uint32_t ones = 0;
+    for (size_t i = 0; i < bits.size(); i++) {
+        if (i % WORDS_PER_BLOCK == 0) {
+            blockRanks.push_back(ones);
+        }
+        ones += __builtin_popcountll(bits[i]);
+    }
+    blockRanks.push_back(ones);
+}
+
+/* number of ones in positions [0, i) */
+size_t BitVector::rank1(size_t i) const {
+    size_t block = i / BLOCK_BITS;
+    size_t rank = blockRanks[block];
+    for (size_t w = block * WORDS_PER_BLOCK; w < i / 64; w++) {
+        rank += __builtin_popcountll(bits[w]);
+    }
+    if (i % 64 != 0) {
+        rank += __builtin_popcountll(bits[i / 64] &
+                                     (((uint64_t)1 << (i % 64)) - 1));
+    }
+    return rank;
+}
+
+/* position of the j-th zero, j starting at 1 */
+size_t BitVector::select0(size_t j) const {
+    // last block with fewer than j zeros before it
+    size_t low = 0;
+    size_t high = blockRanks.size() - 1;
+    while (low + 1 < high) {
+        size_t mid = (low + high) / 2;
+        if (mid * BLOCK_BITS - blockRanks[mid] < j) {
+            low = mid;
+        } else {
+            high = mid;
+        }
+    }
+
+    size_t zeros = low * BLOCK_BITS - blockRanks[low];
+    size_t w = low * WORDS_PER_BLOCK;
+    while (zeros + 64 - __builtin_popcountll(bits[w]) < j) {
+        zeros += 64 - __builtin_popcountll(bits[w]);
+        w++;
+    }
+    for (size_t i = w * 64;; i++) {
+        if (!get(i) && ++zeros == j) {
+            return i;
+        }
+    }
+}
+
+/* bytes held by the bits and the rank directory */
+size_t BitVector::sizeInBytes() const {
+    return bits.size() * sizeof(uint64_t) +
+           blockRanks.size() * sizeof(uint32_t);
+}
+
+/* Initializes an array able to hold values up to maxValue */
+PackedArray::PackedArray(uint64_t maxValue) : width(1), count(0) {
+    while (width < 64 && (maxValue >> width) != 0) {
+        width++;
+    }
+}
+
+void PackedArray::push_back(uint64_t value) {
+    size_t position = count * width;
+    while (bits.size() * 64 < position + width) {
+        bits.push_back(0);
+    }
+    bits[position / 64] |= value << (position % 64);
+    // the value runs over into the next word
+    if (position % 64 + width > 64) {
+        bits[position / 64 + 1] |= value >> (64 - position % 64);
+    }
+    count++;
+}
+
+uint64_t PackedArray::get(size_t i) const {
+    size_t position = i * width;
+    uint64_t value = bits[position / 64] >> (position % 64);
+    if (position % 64 + width > 64) {
+        value |= bits[position / 64 + 1] << (64 - position % 64);
+    }
+    return width == 64 ? value : value & (((uint64_t)1 << width) - 1);
+}
+
+/**
+ * Succinct trie constructor
+ * Walks the alphabetically sorted words breadth first, every node
+ * is the range of words sharing its prefix
+ */
+SuccinctTrie::SuccinctTrie(const DictionaryTrie& dict) : numWords(0) {
+    vector<pair<unsigned int, string>> words;
+    dict.collectWords(words);
+    numWords = words.size();
+
+    unsigned int maxFrequency = 0;
+    for (size_t i = 0; i < words.size(); i++) {
+        maxFrequency = max(maxFrequency, words[i].first);
+    }
+    frequencies = PackedArray(maxFrequency);
+
+    // super root pointing at the root
+    louds.push_back(1);
+    louds.push_back(0);
+
+    // <first word, last word, depth> of each node in breadth first order
+    queue<tuple<size_t, size_t, size_t>> nodes;
+    nodes.push(make_tuple(0, words.size(), 0));
+    while (!nodes.empty()) {
+        size_t first, last, depth;
+        tie(first, last, depth) = nodes.front();
+        nodes.pop();
+
+        unsigned int nodeMax = 0;
+        for (size_t i = first; i < last; i++) {
+            nodeMax = max(nodeMax, words[i].first);
+        }
+        maxBound.push_back(quantize(nodeMax));
+
+        // a word ending here sorts before the longer words below
+        bool isWord = first < last && words[first].second.length() == depth;
+        terminal.push_back(isWord);
+        if (isWord) {
+            frequencies.push_back(words[first].first);
+            first++;
+        }
+
+        // one child per distinct next letter
+        while (first < last) {
+            char c = words[first].second[depth];
+            size_t end = first;
+            while (end < last && words[end].second[depth] == c) {
+                end++;
+            }
+            louds.push_back(1);
+            labels.push_back(c);
+            nodes.push(make_tuple(first, end, depth + 1));
+            first = end;
+        }
+        louds.push_back(0);
+    }
+
+    louds.build();
+    terminal.build();
+}
+
+/* finds a word in the dictionary
+ * @return true if found false otherwise
+ **/
+bool SuccinctTrie::find(const string& word) const {
+    size_t node = findNode(word);
+    return node != 0 && terminal.get(node);
+}
+
+/* predicts words given a prefix based on words with
+ * the highest frequencies
+ * @return a vector of suggested completions, same order as
+ * DictionaryTrie::predictCompletions
+ **/
+vector<string> SuccinctTrie::predictCompletions(
+    const string& prefix, unsigned int numCompletions) const {
+    vector<string> completionSet;
+    size_t start = findNode(prefix);
+    if (numCompletions <= 0 || start == 0) {
+        return completionSet;
+    }
+
+    // best first: always expand the node with the highest bound and stop
+    // once no bound can beat the worst of the numCompletions kept
+    typedef pair<unsigned long long, pair<size_t, string>> Candidate;
+    priority_queue<Candidate> candidates;
+    WordPQ completions;
+    candidates.push(Candidate(dequantize(maxBound[start]),
+                              make_pair(start, prefix)));
+
+    while (!candidates.empty()) {
+        Candidate candidate = candidates.top();
+        candidates.pop();
+        if (completions.size() == numCompletions &&
+            candidate.first < (unsigned int)completions.top().first) {
+            break;
+        }
+
+        size_t node = candidate.second.first;
+        const string& word = candidate.second.second;
+        if (terminal.get(node)) {
+            completions.push(pair<int, string>(frequencyOf(node), word));
+            if (completions.size() > numCompletions) {
+                completions.pop();
+            }
+        }
+
+        size_t first, last;
+        children(node, first, last);
+        for (size_t child = first; child < last; child++) {
+            unsigned long long bound = dequantize(maxBound[child]);
+            if (completions.size() < numCompletions ||
+                bound >= (unsigned int)completions.top().first) {
+                candidates.push(Candidate(
+                    bound, make_pair(child, word + labels[child - 1])));
+            }
+        }
+    }
+
+    while (!completions.empty()) {
+        completionSet.push_back(completions.top().second);
+        completions.pop();
+    }
+    return completionSet;
+}
+
+/* bytes held by every structure of the trie */
+size_t SuccinctTrie::sizeInBytes() const {
+    return sizeof(SuccinctTrie) + louds.sizeInBytes() +
+           terminal.sizeInBytes() + labels.size() * sizeof(char) +
+           maxBound.size() * sizeof(uint8_t) + frequencies.sizeInBytes();
+}
+
+/* bits used per stored word */
+double SuccinctTrie::bitsPerWord() const {
+    return numWords == 0 ? 0.0 : sizeInBytes() * 8.0 / numWords;
+}
+
+/* bound of every code: ceil(2^(code / 7)) - 1 */
+static vector<unsigned long long> makeBounds() {
+    vector<unsigned long long> bounds(256);
+    for (unsigned int i = 0; i < bounds.size(); i++) {
+        bounds[i] =
+            (unsigned long long)ceil(pow(2.0, i / STEPS_PER_DOUBLING)) - 1;
+    }
+    return bounds;
+}
+
+/* upper bound a code stands for */
+unsigned long long SuccinctTrie::dequantize(uint8_t code) {
+    static const vector<unsigned long long> bounds = makeBounds();
+    return bounds[code];
+}
+
+/* smallest 8 bit code whose bound is at least freq */
+uint8_t SuccinctTrie::quantize(unsigned int freq) {
+    unsigned int code = 0;
+    while (code < 255 && dequantize(code) < freq) {
+        code++;
+    }
+    return code;
+}
+
+/**
+ * Children Helper
+ * the children of node are the ones after its (node + 1)-th zero
+ */
+void SuccinctTrie::children(size_t node, size_t& first, size_t& last) const {
+    size_t start = louds.select0(node + 1) + 1;
+    size_t end = louds.select0(node + 2);
+    first = louds.rank1(start);
+    last = first + (end - start);
+}
+
+/**
+ * Child Helper
+ * siblings are sorted by label, so binary search them
+ */
+size_t SuccinctTrie::findChild(size_t node, char c) const {
+    size_t first, last;
+    children(node, first, last);
+    while (first < last) {
+        size_t mid = (first + last) / 2;
+        if (labels[mid - 1] < c) {
+            first = mid + 1;
+        } else if (labels[mid - 1] > c) {
+            last = mid;
+        } else {
+            return mid;
+        }
+    }
+    return 0;
+}
+
+/**
+ * findNode: Helper Method for Find
+ */
+size_t SuccinctTrie::findNode(const string& prefix) const {
+    if (prefix.empty() || numWords == 0) {
+        return 0;
+    }
+    size_t node = 0;
+    for (size_t i = 0; i < prefix.length() && (i == 0 || node != 0); i++) {
+        node = findChild(node, prefix[i]);
+    }
+    return node;
+}
+
+/**
+ * Frequency Helper
+ * frequencies are stored in node order for word nodes only
+ */
+unsigned int SuccinctTrie::frequencyOf(size_t node) const {
+    return frequencies.get(terminal.rank1(node));
+}
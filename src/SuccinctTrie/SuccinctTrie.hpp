@@ -0,0 +1,139 @@
+/**
+ * This hpp file defines the SuccinctTrie, a read only copy of a
+ * DictionaryTrie stored as a LOUDS (level order unary degree
+ * sequence) bit vector, plus the BitVector and PackedArray it
+ * is built from
+ */
+#ifndef SUCCINCT_TRIE_HPP
+#define SUCCINCT_TRIE_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "DictionaryTrie.hpp"
+
+using namespace std;
+
+/**
+ * A bit vector supporting rank and select. Ranks are precomputed
+ * every 512 bits, select binary searches those counts and then
+ * scans at most one block.
+ */
+class BitVector {
+  private:
+    vector<uint64_t> bits;
+    vector<uint32_t> blockRanks;  // ones before each 512 bit block
+    size_t numBits;
+    size_t numOnes;
+
+  public:
+    /* Initializes an empty bit vector */
+    BitVector();
+
+    /* appends a bit, rank and select need build() afterwards */
+    void push_back(bool bit);
+
+    /* precomputes the rank directory */
+    void build();
+
+    /* value of the bit at position i */
+    bool get(size_t i) const { return (bits[i / 64] >> (i % 64)) & 1; }
+
+    /* number of ones in positions [0, i) */
+    size_t rank1(size_t i) const;
+
+    /* number of zeros in positions [0, i) */
+    size_t rank0(size_t i) const { return i - rank1(i); }
+
+    /* position of the j-th zero, j starting at 1 */
+    size_t select0(size_t j) const;
+
+    size_t size() const { return numBits; }
+
+    /* bytes held by the bits and the rank directory */
+    size_t sizeInBytes() const;
+};
+
+/**
+ * An array of unsigned values packed with the fewest bits that
+ * hold the largest of them
+ */
+class PackedArray {
+  private:
+    vector<uint64_t> bits;
+    unsigned int width;
+    size_t count;
+
+  public:
+    /* Initializes an array able to hold values up to maxValue */
+    PackedArray(uint64_t maxValue = 0);
+
+    void push_back(uint64_t value);
+
+    uint64_t get(size_t i) const;
+
+    size_t size() const { return count; }
+
+    /* bytes held by the packed values */
+    size_t sizeInBytes() const { return bits.size() * sizeof(uint64_t); }
+};
+
+/**
+ * A static multi-way trie of every word in a DictionaryTrie.
+ * Node ids follow breadth first order, the tree shape lives in
+ * the LOUDS bit vector, each node keeps its label, a word flag
+ * and an 8 bit upper bound of the highest frequency below it,
+ * and the exact frequencies of the words are bit packed.
+ */
+class SuccinctTrie {
+  private:
+    BitVector louds;
+    BitVector terminal;           // word flag by node id
+    vector<char> labels;          // label of node id i + 1
+    vector<uint8_t> maxBound;     // quantized subtrie max by node id
+    PackedArray frequencies;      // by rank of the node in terminal
+    size_t numWords;
+
+    /* range [first, last) of the child ids of a node */
+    void children(size_t node, size_t& first, size_t& last) const;
+    /* id of the child of node labeled c, 0 if there is none */
+    size_t findChild(size_t node, char c) const;
+    /* id of the node a prefix ends at, 0 if there is none */
+    size_t findNode(const string& prefix) const;
+    /* exact frequency of a terminal node */
+    unsigned int frequencyOf(size_t node) const;
+
+  public:
+    /* Builds the succinct copy of every word in dict */
+    SuccinctTrie(const DictionaryTrie& dict);
+
+    /* finds a word in the dictionary
+     * @return true if found false otherwise
+     **/
+    bool find(const string& word) const;
+
+    /* predicts words given a prefix based on words with
+     * the highest frequencies
+     * @return a vector of suggested completions, same order as
+     * DictionaryTrie::predictCompletions
+     **/
+    vector<string> predictCompletions(const string& prefix,
+                                      unsigned int numCompletions) const;
+
+    /* number of words stored */
+    size_t size() const { return numWords; }
+
+    /* bytes held by every structure of the trie */
+    size_t sizeInBytes() const;
+
+    /* bits used per stored word */
+    double bitsPerWord() const;
+
+    /* smallest 8 bit code whose bound is at least freq */
+    static uint8_t quantize(unsigned int freq);
+
+    /* upper bound a code stands for */
+    static unsigned long long dequantize(uint8_t code);
+};
+
+#endif  // SUCCINCT_TRIE_HPP
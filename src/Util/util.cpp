@@ -3,11 +3,27 @@
  * benchmarking DictionaryTrie
  */
 #include "util.hpp"
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <iomanip>
 #include <iostream>
+#include <iterator>
 #include <sstream>
+#include <thread>
+#include "SortedArrayDictionary.hpp"
 
 /* Starts the timer. Saves the current time. */
-void Timer::begin_timer() { start = std::chrono::high_resolution_clock::now(); }
+void Timer::begin_timer() {
+    if (counters != nullptr) {
+        counters->begin();
+    }
+    start = std::chrono::high_resolution_clock::now();
+}
 
 /* Ends the timer. Compares end time with the start time and returns number of
  * nanoseconds
@@ -15,99 +31,259 @@ void Timer::begin_timer() { start = std::chrono::high_resolution_clock::now(); }
 long long Timer::end_timer() {
     std::chrono::time_point<std::chrono::high_resolution_clock> end;
     end = std::chrono::high_resolution_clock::now();
+    if (counters != nullptr) {
+        counters->end();
+    }
 
     return (long long)std::chrono::duration_cast<std::chrono::nanoseconds>(
                end - start)
         .count();
 }
 
-/* Load all the words in word stream into the dictionary trie */
-void Utils::loadDict(DictionaryTrie& dict, istream& words) {
+/* perf_event_attr type and config of every PerfCounters::Event */
+static const struct {
+    uint32_t type;
+    uint64_t config;
+    const char* name;
+} PERF_EVENTS[PerfCounters::NUM_EVENTS] = {
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES, "cycles"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS, "instructions"},
+    {PERF_TYPE_HW_CACHE,
+     PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+         (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+     "L1d misses"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES, "LLC misses"},
+    {PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES, "branch misses"}};
+
+/* Opens every counter it can, none if enable is false */
+PerfCounters::PerfCounters(bool enable) {
+    for (unsigned int i = 0; i < NUM_EVENTS; i++) {
+        counts[i] = 0;
+        fds[i] = -1;
+        if (!enable) {
+            continue;
+        }
+
+        perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = PERF_EVENTS[i].type;
+        attr.config = PERF_EVENTS[i].config;
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        attr.read_format =
+            PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        // this thread, on any cpu
+        fds[i] = syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+    }
+    if (enable && !available()) {
+        cerr << "perf_event_open: " << strerror(errno)
+             << ", reporting times only" << endl;
+    }
+}
+
+/* true if at least one counter could be opened */
+bool PerfCounters::available() const {
+    for (unsigned int i = 0; i < NUM_EVENTS; i++) {
+        if (fds[i] >= 0) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/* Function called when starting a measured phase, resets the counters */
+void PerfCounters::begin() {
+    for (unsigned int i = 0; i < NUM_EVENTS; i++) {
+        if (fds[i] >= 0) {
+            ioctl(fds[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+/* Function called when ending a measured phase, stops the counters */
+void PerfCounters::end() {
+    for (unsigned int i = 0; i < NUM_EVENTS; i++) {
+        if (fds[i] >= 0) {
+            ioctl(fds[i], PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+    for (unsigned int i = 0; i < NUM_EVENTS; i++) {
+        counts[i] = 0;
+        // value, time enabled, time running
+        uint64_t values[3];
+        if (fds[i] < 0 || read(fds[i], values, sizeof(values)) !=
+                              (ssize_t)sizeof(values)) {
+            continue;
+        }
+        if (values[2] > 0) {
+            counts[i] = (unsigned long long)((double)values[0] * values[1] /
+                                             values[2]);
+        }
+    }
+}
+
+/* prints the per query averages of the last phase */
+void PerfCounters::report(ostream& out, unsigned long long numQueries) const {
+    if (!available() || numQueries == 0) {
+        return;
+    }
+    out << "\tPer query:";
+    for (unsigned int i = 0; i < NUM_EVENTS; i++) {
+        if (fds[i] >= 0) {
+            out << " " << PERF_EVENTS[i].name << " " << fixed
+                << setprecision(1) << (double)counts[i] / numQueries;
+        }
+    }
+    if (counting(CYCLES) && counting(INSTRUCTIONS) && counts[CYCLES] > 0) {
+        out << ", IPC " << setprecision(2)
+            << (double)counts[INSTRUCTIONS] / counts[CYCLES];
+    }
+    out.unsetf(ios::floatfield);
+    out << setprecision(6) << endl;
+}
+
+/* Destructor, closes the counters */
+PerfCounters::~PerfCounters() {
+    for (unsigned int i = 0; i < NUM_EVENTS; i++) {
+        if (fds[i] >= 0) {
+            close(fds[i]);
+        }
+    }
+}
+
+/* Splits a dictionary file line into its frequency and its words joined
+ * by single spaces, up to a "." word. freq is 0 if the line does not
+ * start with a number
+ */
+void Utils::parseLine(const string& line, unsigned int& freq, string& word) {
+    istringstream iss(line);
+    freq = 0;
+    word = "";
+    if (!(iss >> freq)) {
+        freq = 0;
+        return;
+    }
+    string token;
+    while (iss >> token && token != ".") {
+        if (!word.empty()) word += " ";
+        word += token;
+    }
+}
+
+/* Load all the words in word stream into the dictionary */
+void Utils::loadDict(DictionaryEngine& dict, istream& words) {
     unsigned int freq;
-    string data = "";
-    string tempWord;
+    string data;
     string word;
-    vector<string> wordString;
-    unsigned int i;
     while (getline(words, data)) {
-        tempWord = "";
-        word = "";
-        data = data + " .";
-        istringstream iss(data);
-        iss >> freq;
-        while (1) {
-            iss >> tempWord;
-            if (tempWord == ".") break;
-            if (tempWord.length() > 0) wordString.push_back(tempWord);
-        }
-        for (i = 0; i < wordString.size(); i++) {
-            if (i > 0) word = word + " ";
-            word = word + wordString[i];
-        }
+        parseLine(data, freq, word);
         dict.insert(word, freq);
-        wordString.clear();
-        if (words.eof()) break;
     }
 }
 
 /* Load numWords from words stream into the dictionary trie */
-void Utils::loadDict(DictionaryTrie& dict, istream& words,
+void Utils::loadDict(DictionaryEngine& dict, istream& words,
                      unsigned int numWords) {
     unsigned int freq;
-    string data = "";
-    string tempWord;
+    string data;
     string word;
-    vector<string> wordString;
-    unsigned int i;
-    unsigned int j = 0;
-    for (; j < numWords; j++) {
-        getline(words, data);
-        tempWord = "";
-        word = "";
-        data = data + " .";
-        istringstream iss(data);
-        iss >> freq;
-        while (1) {
-            iss >> tempWord;
-            if (tempWord == ".") break;
-            if (tempWord.length() > 0) wordString.push_back(tempWord);
-        }
-        for (i = 0; i < wordString.size(); i++) {
-            if (i > 0) word = word + " ";
-            word = word + wordString[i];
-        }
+    for (unsigned int j = 0; j < numWords && getline(words, data); j++) {
+        parseLine(data, freq, word);
         dict.insert(word, freq);
-        wordString.clear();
-        if (words.eof()) break;
     }
 }
 
+/* Load the words in the file into the dictionary using numThreads
+ * threads to parse and build, same result as loadDict
+ */
+void Utils::loadDictParallel(DictionaryTrie& dict, istream& words,
+                             unsigned int numThreads) {
+    if (numThreads == 0) {
+        numThreads = 1;
+    }
+    string data((istreambuf_iterator<char>(words)), istreambuf_iterator<char>());
+
+    // split into chunks that end on line boundaries
+    vector<size_t> bounds(1, 0);
+    for (unsigned int i = 1; i < numThreads; i++) {
+        size_t bound = max(bounds.back(), data.size() * i / numThreads);
+        bound = data.find('\n', bound);
+        bound = bound == string::npos ? data.size() : bound + 1;
+        bounds.push_back(bound);
+    }
+    bounds.push_back(data.size());
+
+    // every thread parses its own chunk with the sequential loader
+    vector<vector<pair<unsigned int, string>>> chunks(numThreads);
+    vector<thread> workers;
+    for (unsigned int i = 0; i < numThreads; i++) {
+        workers.push_back(thread([&, i]() {
+            istringstream chunk(
+                data.substr(bounds[i], bounds[i + 1] - bounds[i]));
+            loadDict(chunks[i], chunk);
+        }));
+    }
+    for (unsigned int i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+
+    // group by first letter, keeping file order within and between groups
+    vector<vector<pair<unsigned int, string>>> groups;
+    vector<int> groupOf(256, -1);
+    for (unsigned int i = 0; i < chunks.size(); i++) {
+        for (unsigned int j = 0; j < chunks[i].size(); j++) {
+            if (chunks[i][j].second.empty()) continue;
+            unsigned char first = chunks[i][j].second[0];
+            if (groupOf[first] < 0) {
+                groupOf[first] = groups.size();
+                groups.push_back(vector<pair<unsigned int, string>>());
+            }
+            groups[groupOf[first]].push_back(chunks[i][j]);
+        }
+    }
+
+    dict.buildParallel(groups, numThreads);
+}
+
 /* Load all the words in word stream into a vector */
 void Utils::loadDict(vector<string>& dict, istream& words) {
     unsigned int junk;
-    string data = "";
-    string tempWord;
+    string data;
     string word;
-    vector<string> wordString;
-    unsigned int i;
-
     while (getline(words, data)) {
-        tempWord = "";
-        word = "";
-        data = data + " .";
-        istringstream iss(data);
-        iss >> junk;
-        while (1) {
-            iss >> tempWord;
-            if (tempWord == ".") break;
-            if (tempWord.length() > 0) wordString.push_back(tempWord);
-        }
-        for (i = 0; i < wordString.size(); i++) {
-            if (i > 0) word = word + " ";
-            word = word + wordString[i];
-        }
+        parseLine(data, junk, word);
         dict.push_back(word);
-        wordString.clear();
-        if (words.eof()) break;
     }
 }
+
+/* Load all the <frequency, word> pairs in word stream into a vector */
+void Utils::loadDict(vector<pair<unsigned int, string>>& dict,
+                     istream& words) {
+    unsigned int freq;
+    string data;
+    string word;
+    while (getline(words, data)) {
+        parseLine(data, freq, word);
+        dict.push_back(pair<unsigned int, string>(freq, word));
+    }
+}
+
+/* names newEngine knows, the first is the default */
+const vector<string> Utils::ENGINE_NAMES = {"trie", "sorted"};
+
+/* a new empty dictionary of the structure with the given name, the
+ * caller deletes it
+ * @return nullptr if no engine has that name
+ */
+DictionaryEngine* Utils::newEngine(const string& name) {
+    if (name == "trie") {
+        return new DictionaryTrie();
+    }
+    if (name == "sorted") {
+        return new SortedArrayDictionary();
+    }
+    return nullptr;
+}
@@ -13,12 +13,69 @@
 
 using namespace std;
 
+/** Hardware performance counters of the calling thread, read with the
+ * Linux perf_event_open interface. Counters the kernel or the machine
+ * does not provide are left out, and without any counter begin, end
+ * and report do nothing
+ */
+class PerfCounters {
+  public:
+    /* the events counted, in report order */
+    enum Event {
+        CYCLES,
+        INSTRUCTIONS,
+        L1D_MISSES,
+        LLC_MISSES,
+        BRANCH_MISSES,
+        NUM_EVENTS
+    };
+
+  private:
+    int fds[NUM_EVENTS];
+    unsigned long long counts[NUM_EVENTS];
+
+  public:
+    /* Opens every counter it can, none if enable is false */
+    PerfCounters(bool enable = true);
+
+    // owns file descriptors
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    /* true if at least one counter could be opened */
+    bool available() const;
+
+    /* true if the event is counted */
+    bool counting(Event event) const { return fds[event] >= 0; }
+
+    /* Function called when starting a measured phase, resets the counters */
+    void begin();
+
+    /* Function called when ending a measured phase, stops the counters */
+    void end();
+
+    /* count of an event over the last phase, scaled up if the kernel had
+     * to share the hardware counter with other events
+     */
+    unsigned long long count(Event event) const { return counts[event]; }
+
+    /* prints the per query averages of the last phase */
+    void report(ostream& out, unsigned long long numQueries) const;
+
+    /* Destructor, closes the counters */
+    ~PerfCounters();
+};
+
 /** Timer class to time the program execution */
 class Timer {
   private:
     std::chrono::time_point<std::chrono::high_resolution_clock> start;
+    PerfCounters* counters;
 
   public:
+    /* counters, if given, run between begin_timer and end_timer */
+    Timer(PerfCounters* counters = nullptr) : counters(counters) {}
+
     /* Function called when starting the timer. */
     void begin_timer();
 
@@ -31,15 +88,42 @@ class Timer {
 /** Contains useful functions to parse input file */
 class Utils {
   public:
+    /* Splits a dictionary file line into its frequency and its words
+     * joined by single spaces, up to a "." word. Every loader below
+     * parses lines with it. freq is 0 if the line does not start with
+     * a number
+     */
+    void static parseLine(const string& line, unsigned int& freq,
+                          string& word);
+
     /* Load the words in the file into the dictionary */
-    void static loadDict(DictionaryTrie& dict, istream& words);
+    void static loadDict(DictionaryEngine& dict, istream& words);
 
     /* Load numWords from words stream into the dictionary */
-    void static loadDict(DictionaryTrie& dict, istream& words,
+    void static loadDict(DictionaryEngine& dict, istream& words,
                          unsigned int numWords);
 
+    /* Load the words in the file into the dictionary using numThreads
+     * threads to parse and build, same result as loadDict
+     */
+    void static loadDictParallel(DictionaryTrie& dict, istream& words,
+                                 unsigned int numThreads);
+
     /* Load all the words in word stream into a vector */
     void static loadDict(vector<string>& dict, istream& words);
+
+    /* Load all the <frequency, word> pairs in word stream into a vector */
+    void static loadDict(vector<pair<unsigned int, string>>& dict,
+                         istream& words);
+
+    /* names newEngine knows, the first is the default */
+    static const vector<string> ENGINE_NAMES;
+
+    /* a new empty dictionary of the structure with the given name
+     * ("trie" or "sorted"), the caller deletes it
+     * @return nullptr if no engine has that name
+     */
+    static DictionaryEngine* newEngine(const string& name);
 };
 
 #endif  // UTIL_HPP
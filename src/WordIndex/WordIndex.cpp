@@ -0,0 +1,201 @@
+/**
+ * This file implements the BloomFilter and WordIndex
+ * defined in WordIndex.hpp
+ */
+#include "WordIndex.hpp"
+#include <algorithm>
+
+/* filter bits per expected item, with 7 probes about 1% false positives */
+static const size_t BITS_PER_ITEM = 10;
+static const unsigned int NUM_PROBES = 7;
+/* the table grows once it is this many tenths full */
+static const size_t MAX_LOAD_TENTHS = 7;
+
+/* smallest power of two that is at least n */
+static size_t powerOfTwo(size_t n) {
+    size_t power = 1;
+    while (power < n) {
+        power *= 2;
+    }
+    return power;
+}
+
+/* Initializes a filter for up to expectedItems items */
+BloomFilter::BloomFilter(size_t expectedItems) {
+    size_t numBits =
+        powerOfTwo(max<size_t>(64, expectedItems * BITS_PER_ITEM));
+    bits.assign(numBits / 64, 0);
+    mask = numBits - 1;
+}
+
+void BloomFilter::add(uint64_t hash) {
+    uint64_t step = (hash >> 32) | 1;
+    for (unsigned int i = 0; i < NUM_PROBES; i++) {
+        uint64_t bit = (hash + i * step) & mask;
+        bits[bit / 64] |= (uint64_t)1 << (bit % 64);
+    }
+}
+
+/* false if the item was never added, true if it probably was */
+bool BloomFilter::mayContain(uint64_t hash) const {
+    uint64_t step = (hash >> 32) | 1;
+    for (unsigned int i = 0; i < NUM_PROBES; i++) {
+        uint64_t bit = (hash + i * step) & mask;
+        if (((bits[bit / 64] >> (bit % 64)) & 1) == 0) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Initializes an index sized for expectedWords words */
+WordIndex::WordIndex(size_t expectedWords)
+    : slots(powerOfTwo(
+          max<size_t>(16, expectedWords * 10 / MAX_LOAD_TENTHS + 1))),
+      numWords(0) {
+    filter = BloomFilter(slots.size() * MAX_LOAD_TENTHS / 10);
+}
+
+/* adds a word
+ * @return true if added, false if the word is already there, is
+ * empty or has frequency 0
+ **/
+bool WordIndex::insert(const string& word, unsigned int freq) {
+    if (word.empty() || freq == 0) {
+        return false;
+    }
+    if ((numWords + 1) * 10 > slots.size() * MAX_LOAD_TENTHS) {
+        grow();
+    }
+
+    uint64_t wordHash = hash(word);
+    Slot& slot = slots[probe(word, wordHash)];
+    if (slot.length != 0) {
+        return false;
+    }
+    slot.offset = words.size();
+    slot.length = word.length();
+    slot.frequency = freq;
+    slot.tag = wordHash >> 32;
+    words += word;
+    filter.add(wordHash);
+    numWords++;
+    return true;
+}
+
+/* true if the word has been added */
+bool WordIndex::contains(const string& word) const {
+    return frequency(word) != 0;
+}
+
+/* frequency of a word
+ * @return 0 if the word has not been added
+ **/
+unsigned int WordIndex::frequency(const string& word) const {
+    const Slot* slot = lookup(word);
+    if (slot == nullptr) {
+        return 0;
+    }
+    return __atomic_load_n(&slot->frequency, __ATOMIC_RELAXED);
+}
+
+/* adds count to the frequency of a word, safe alongside lookups
+ * and other frequency updates but not alongside insert
+ * @return false if the word has not been added
+ **/
+bool WordIndex::addFrequency(const string& word, unsigned int count) {
+    Slot* slot = const_cast<Slot*>(lookup(word));
+    if (slot == nullptr) {
+        return false;
+    }
+    __atomic_fetch_add(&slot->frequency, count, __ATOMIC_RELAXED);
+    return true;
+}
+
+/* sets the frequency of a word, with the same safety as addFrequency
+ * @return false if the word has not been added
+ **/
+bool WordIndex::setFrequency(const string& word, unsigned int freq) {
+    Slot* slot = const_cast<Slot*>(lookup(word));
+    if (slot == nullptr || freq == 0) {
+        return false;
+    }
+    __atomic_store_n(&slot->frequency, freq, __ATOMIC_RELAXED);
+    return true;
+}
+
+/* bytes held by the table, the words and the filter */
+size_t WordIndex::sizeInBytes() const {
+    return sizeof(WordIndex) + slots.capacity() * sizeof(Slot) +
+           words.capacity() + filter.sizeInBytes();
+}
+
+/* FNV-1a, finished with the MurmurHash3 mixer so every bit of the
+ * result depends on every character
+ */
+uint64_t WordIndex::hash(const string& word) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned int i = 0; i < word.length(); i++) {
+        hash = (hash ^ (unsigned char)word[i]) * 1099511628211ull;
+    }
+    hash ^= hash >> 33;
+    hash *= 0xff51afd7ed558ccdull;
+    hash ^= hash >> 33;
+    hash *= 0xc4ceb9fe1a85ec53ull;
+    hash ^= hash >> 33;
+    return hash;
+}
+
+/**
+ * Probe Helper
+ * the tag and length are compared before the characters
+ */
+size_t WordIndex::probe(const string& word, uint64_t hash) const {
+    size_t mask = slots.size() - 1;
+    uint32_t tag = hash >> 32;
+    for (size_t i = hash & mask;; i = (i + 1) & mask) {
+        const Slot& slot = slots[i];
+        if (slot.length == 0 ||
+            (slot.tag == tag && slot.length == word.length() &&
+             words.compare(slot.offset, slot.length, word) == 0)) {
+            return i;
+        }
+    }
+}
+
+/**
+ * Lookup Helper
+ * the filter turns most absent words away before the table is probed
+ */
+const WordIndex::Slot* WordIndex::lookup(const string& word) const {
+    if (word.empty()) {
+        return nullptr;
+    }
+    uint64_t wordHash = hash(word);
+    if (!filter.mayContain(wordHash)) {
+        return nullptr;
+    }
+    const Slot& slot = slots[probe(word, wordHash)];
+    return slot.length == 0 ? nullptr : &slot;
+}
+
+/**
+ * Grow Helper
+ * rehashes every word into a table twice the size, and rebuilds
+ * the filter for the words the new table can hold
+ */
+void WordIndex::grow() {
+    vector<Slot> old(slots.size() * 2);
+    old.swap(slots);
+    filter = BloomFilter(slots.size() * MAX_LOAD_TENTHS / 10);
+
+    for (size_t i = 0; i < old.size(); i++) {
+        if (old[i].length == 0) {
+            continue;
+        }
+        string word = words.substr(old[i].offset, old[i].length);
+        uint64_t wordHash = hash(word);
+        slots[probe(word, wordHash)] = old[i];
+        filter.add(wordHash);
+    }
+}
@@ -0,0 +1,103 @@
+/**
+ * This hpp file defines the WordIndex, a hash table of words and
+ * their frequencies that answers exact membership in expected O(1),
+ * and the BloomFilter it uses to turn most absent words away
+ * before probing the table
+ */
+#ifndef WORD_INDEX_HPP
+#define WORD_INDEX_HPP
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ * A Bloom filter over 64 bit hashes, sized for about 1% false
+ * positives. Derives its probes from the two halves of one hash.
+ */
+class BloomFilter {
+  private:
+    vector<uint64_t> bits;
+    uint64_t mask;  // number of bits - 1, a power of two
+
+  public:
+    /* Initializes a filter for up to expectedItems items */
+    BloomFilter(size_t expectedItems = 0);
+
+    void add(uint64_t hash);
+
+    /* false if the item was never added, true if it probably was */
+    bool mayContain(uint64_t hash) const;
+
+    /* bytes held by the bits */
+    size_t sizeInBytes() const { return bits.size() * sizeof(uint64_t); }
+};
+
+/**
+ * An open addressing hash table from words to frequencies with
+ * linear probing. The words are packed one after another in a
+ * single string and every slot refers to its word by offset.
+ */
+class WordIndex {
+  private:
+    struct Slot {
+        uint32_t offset;     // start of the word in words
+        uint32_t length;     // 0 for an empty slot
+        uint32_t frequency;  // read and updated with __atomic builtins
+        uint32_t tag;        // high half of the hash, checked first
+    };
+
+    vector<Slot> slots;
+    string words;
+    BloomFilter filter;
+    size_t numWords;
+
+    /* slot holding word, or the empty slot where it would go */
+    size_t probe(const string& word, uint64_t hash) const;
+    /* slot holding word, nullptr if it has not been added */
+    const Slot* lookup(const string& word) const;
+    /* doubles the table and rebuilds the filter */
+    void grow();
+
+  public:
+    /* Initializes an index sized for expectedWords words */
+    WordIndex(size_t expectedWords = 0);
+
+    /* adds a word
+     * @return true if added, false if the word is already there, is
+     * empty or has frequency 0
+     **/
+    bool insert(const string& word, unsigned int freq);
+
+    /* true if the word has been added */
+    bool contains(const string& word) const;
+
+    /* frequency of a word
+     * @return 0 if the word has not been added
+     **/
+    unsigned int frequency(const string& word) const;
+
+    /* adds count to the frequency of a word, safe alongside lookups
+     * and other frequency updates but not alongside insert
+     * @return false if the word has not been added
+     **/
+    bool addFrequency(const string& word, unsigned int count);
+
+    /* sets the frequency of a word, with the same safety as addFrequency
+     * @return false if the word has not been added
+     **/
+    bool setFrequency(const string& word, unsigned int freq);
+
+    /* number of words stored */
+    size_t size() const { return numWords; }
+
+    /* bytes held by the table, the words and the filter */
+    size_t sizeInBytes() const;
+
+    /* 64 bit hash of a word */
+    static uint64_t hash(const string& word);
+};
+
+#endif  // WORD_INDEX_HPP
@@ -7,12 +7,17 @@
  * Authors: Bijan Afghani
  *          Joseph Mattingly
  */
+#include <signal.h>
 #include <algorithm>
+#include <chrono>
+#include <cstdlib>
 #include <fstream>
 #include <iostream>
 #include <sstream>
 #include <stack>
+#include <thread>
 #include <vector>
+#include "AutocompleteServer.hpp"
 #include "DictionaryTrie.hpp"
 #include "util.hpp"
 
@@ -40,6 +45,90 @@ bool fileValid(const char* fileName) {
     return true;
 }
 
+/* server being run, for the signal handler */
+static AutocompleteServer* runningServer = nullptr;
+
+/* SIGINT/SIGTERM handler, shuts the server down cleanly */
+void stopServer(int) {
+    if (runningServer != nullptr) {
+        runningServer->stop();
+    }
+}
+
+/* Serves the loaded dictionary over a Unix socket until interrupted,
+ * cutting every query short after QUERY_TIME_LIMIT so one expensive
+ * request cannot hold up a worker
+ */
+int serve(const DictionaryTrie& dict, const string& socketPath,
+          unsigned int numWorkers) {
+    const chrono::milliseconds QUERY_TIME_LIMIT(20);
+    AutocompleteServer server(dict, numWorkers, 0, QUERY_TIME_LIMIT);
+    if (!server.listen(socketPath)) {
+        return -1;
+    }
+    runningServer = &server;
+    signal(SIGINT, stopServer);
+    signal(SIGTERM, stopServer);
+
+    cout << "Serving on " << socketPath << " with " << numWorkers
+         << " workers" << endl;
+    bool served = server.run();
+    runningServer = nullptr;
+    return served ? 0 : -1;
+}
+
+/* Answers every request line of a stream in order, numThreads lines at a
+ * time in parallel, writing one response line per request in large blocks
+ * and the throughput to cerr
+ */
+int runBatch(const DictionaryEngine& dict, istream& requests,
+             unsigned int numThreads) {
+    const unsigned int BATCH_SIZE = 1 << 16;
+    vector<string> lines(BATCH_SIZE);
+    vector<string> responses(BATCH_SIZE);
+    unsigned long long total = 0;
+    Timer timer;
+    timer.begin_timer();
+
+    while (requests) {
+        unsigned int count = 0;
+        while (count < BATCH_SIZE && getline(requests, lines[count])) {
+            if (!lines[count].empty() && lines[count].back() == '\r') {
+                lines[count].pop_back();
+            }
+            count++;
+        }
+
+        // thread t answers lines t, t + numThreads, ...
+        vector<thread> workers;
+        for (unsigned int t = 0; t < numThreads; t++) {
+            workers.push_back(thread([&, t]() {
+                for (unsigned int i = t; i < count; i += numThreads) {
+                    responses[i] = AutocompleteServer::answer(dict, lines[i]);
+                }
+            }));
+        }
+        for (unsigned int t = 0; t < workers.size(); t++) {
+            workers[t].join();
+        }
+
+        string block;
+        for (unsigned int i = 0; i < count; i++) {
+            block += responses[i];
+            block += '\n';
+        }
+        cout.write(block.data(), block.size());
+        total += count;
+    }
+    cout.flush();
+
+    long long time = timer.end_timer();
+    cerr << "Answered " << total << " queries in " << time
+         << " nanoseconds (" << (long long)(total * 1e9 / max(time, 1LL))
+         << " queries/second) with " << numThreads << " threads" << endl;
+    return 0;
+}
+
 /* IMPORTANT! You should use the following lines of code to match the correct
  * output:
  *
@@ -51,28 +140,113 @@ bool fileValid(const char* fileName) {
  * cout << "Continue? (y/n)" << endl;
  *
  * arg 1 - Input file name (in format like freq_dict.txt)
+ * then optionally --engine and the name of the dictionary structure to
+ * answer from, trie (the default) or sorted, and after that either
+ * nothing for the interactive prompt or
+ *
+ * to serve the trie, whose per query time limit needs the trie:
+ * --serve to answer requests on a Unix socket instead
+ * socket path for --serve
+ * optional number of worker threads for --serve
+ *
+ * or, to answer "<numCompletions> <prefix or pattern>" lines in bulk:
+ * --batch
+ * optional query file, - or none for stdin
+ * optional number of threads
  */
 int main(int argc, char** argv) {
     const int NUM_ARG = 2;
-    if (argc != NUM_ARG) {
+    // the mode arguments start after an optional --engine <name>
+    bool engineGiven = argc >= NUM_ARG + 2 && string(argv[2]) == "--engine";
+    int first = engineGiven ? NUM_ARG + 2 : NUM_ARG;
+    int rest = argc - first;
+    bool serverMode =
+        rest >= 2 && rest <= 3 && string(argv[first]) == "--serve";
+    bool batchMode =
+        rest >= 1 && rest <= 3 && string(argv[first]) == "--batch";
+    if (argc < NUM_ARG || (rest != 0 && !serverMode && !batchMode)) {
         cout << "Invalid number of arguments.\n"
-             << "Usage: ./autocomplete <dictionary filename>" << endl;
+             << "Usage: ./autocomplete <dictionary filename> "
+             << "[--engine <name>]\n"
+             << "       ./autocomplete <dictionary filename> --serve "
+             << "<socket path> [workers]\n"
+             << "       ./autocomplete <dictionary filename> "
+             << "[--engine <name>] --batch [query file|-] [threads]"
+             << endl;
         return -1;
     }
-    if (!fileValid(argv[1])) return -1;
 
-    DictionaryTrie* dt = new DictionaryTrie();
+    string engineName = engineGiven ? argv[3] : Utils::ENGINE_NAMES[0];
+    DictionaryEngine* dict = Utils::newEngine(engineName);
+    if (dict == nullptr) {
+        cout << "Unknown engine " << engineName << ", engines:";
+        for (unsigned int i = 0; i < Utils::ENGINE_NAMES.size(); i++) {
+            cout << " " << Utils::ENGINE_NAMES[i];
+        }
+        cout << endl;
+        return -1;
+    }
+    // the server limits the time of every query, which only the trie does
+    DictionaryTrie* dt = dynamic_cast<DictionaryTrie*>(dict);
+    if (serverMode && dt == nullptr) {
+        cout << "--serve answers from the trie engine only" << endl;
+        delete dict;
+        return -1;
+    }
+    if (!fileValid(argv[1])) {
+        delete dict;
+        return -1;
+    }
 
-    // Read all the tokens of the file in order to get every word
-    cout << "Reading file: " << argv[1] << endl;
+    ifstream queries;
+    if (batchMode && rest >= 2 && string(argv[first + 1]) != "-") {
+        if (!fileValid(argv[first + 1])) {
+            delete dict;
+            return -1;
+        }
+        queries.open(argv[first + 1], ios::binary);
+    }
+
+    // Read all the tokens of the file in order to get every word,
+    // batch results own stdout
+    (batchMode ? cerr : cout) << "Reading file: " << argv[1] << endl;
 
     ifstream in;
     in.open(argv[1], ios::binary);
     string word;
 
-    Utils::loadDict(*dt, in);
+    if (dt != nullptr) {
+        Utils::loadDictParallel(*dt, in,
+                                max(1u, thread::hardware_concurrency()));
+    } else {
+        vector<pair<unsigned int, string>> words;
+        Utils::loadDict(words, in);
+        dict->insertAll(words);
+    }
     in.close();
 
+    if (serverMode) {
+        int numWorkers = rest == 3 ? atoi(argv[first + 2]) : 0;
+        if (numWorkers <= 0) {
+            numWorkers = max(1u, thread::hardware_concurrency());
+        }
+        int status = serve(*dt, argv[first + 1], numWorkers);
+        delete dict;
+        return status;
+    }
+
+    if (batchMode) {
+        int numThreads = rest == 3 ? atoi(argv[first + 2]) : 0;
+        if (numThreads <= 0) {
+            numThreads = max(1u, thread::hardware_concurrency());
+        }
+        ios::sync_with_stdio(false);
+        int status = runBatch(*dict, queries.is_open() ? queries : cin,
+                              numThreads);
+        delete dict;
+        return status;
+    }
+
     char cont = 'y';
     unsigned int numberOfCompletions;
     while (cont == 'y') {
@@ -102,10 +276,10 @@ int main(int argc, char** argv) {
 
         if (isUnderscore) {
             sortedCompletions =
-                dt->predictUnderscores(word, numberOfCompletions);
+                dict->predictUnderscores(word, numberOfCompletions);
         } else {
             sortedCompletions =
-                dt->predictCompletions(word, numberOfCompletions);
+                dict->predictCompletions(word, numberOfCompletions);
         }
 
         while (!sortedCompletions.empty()) {
@@ -117,6 +291,6 @@ int main(int argc, char** argv) {
         cin >> cont;
         cin.ignore();
     }
-    delete dt;
+    delete dict;
     return 0;
 }
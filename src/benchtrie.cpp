@@ -1,16 +1,73 @@
 /**
  * Benchmark the autocomplete function in DictionaryTrie
  */
+#include <algorithm>
 #include <fstream>
+#include <random>
 #include <sstream>
+#include "AlphabetTrie.hpp"
 #include "DictionaryTrie.hpp"
+#include "LazyDictionary.hpp"
+#include "ResultCache.hpp"
+#include "SuccinctTrie.hpp"
 #include "util.hpp"
 using namespace std;
 
+/* Builds a query mix of numQueries word prefixes whose popularity follows
+ * a Zipf distribution, the i-th most popular prefix is asked 1/i as often
+ * as the most popular one
+ */
+vector<string> zipfianPrefixes(string filename, unsigned int numQueries) {
+    ifstream in;
+    in.open(filename, ios::binary);
+    vector<string> words;
+    Utils::loadDict(words, in);
+    in.close();
+
+    vector<string> prefixes;
+    for (unsigned int i = 0; i < words.size(); i++) {
+        for (unsigned int length = 1; length <= 3; length++) {
+            if (words[i].length() >= length) {
+                prefixes.push_back(words[i].substr(0, length));
+            }
+        }
+    }
+    sort(prefixes.begin(), prefixes.end());
+    prefixes.erase(unique(prefixes.begin(), prefixes.end()), prefixes.end());
+
+    // rank the prefixes randomly, but the same way on every run
+    mt19937 generator(100);
+    shuffle(prefixes.begin(), prefixes.end(), generator);
+    vector<double> weights;
+    for (unsigned int i = 0; i < prefixes.size(); i++) {
+        weights.push_back(1.0 / (i + 1));
+    }
+    discrete_distribution<unsigned int> zipf(weights.begin(), weights.end());
+
+    vector<string> queries;
+    for (unsigned int i = 0; i < numQueries && !prefixes.empty(); i++) {
+        queries.push_back(prefixes[zipf(generator)]);
+    }
+    return queries;
+}
+
+/* Prints one timing of a test: the time, the counters per query and the
+ * number of results
+ */
+void printTiming(const string& label, long long time,
+                 const PerfCounters& counters, unsigned long long numQueries,
+                 unsigned int count) {
+    cout << "\t" << label << " time taken: " << time << " nanoseconds."
+         << endl;
+    counters.report(cout, numQueries);
+    cout << "\tResults found: " << count << endl;
+}
+
 /* Test the runtime of autocompelte using different prefix and number of
- * completions
+ * completions, with hardware counters per query if perf is set. Test 16
+ * runs the same queries on each of the named dictionary engines
  */
-void testRuntime(string filename) {
+void testRuntime(string filename, bool perf, const vector<string>& engines) {
     const unsigned int NUM_COMP = 10;
 
     ifstream in;
@@ -22,7 +79,8 @@ void testRuntime(string filename) {
     DictionaryTrie* trie = new DictionaryTrie();
     Utils::loadDict(*trie, in);
 
-    Timer timer;
+    PerfCounters counters(perf);
+    Timer timer(&counters);
     vector<string> results;
     long long time = 0;
 
@@ -37,6 +95,7 @@ void testRuntime(string filename) {
     }
     time = timer.end_timer();
     cout << "\tTime taken: " << time << " nanoseconds." << endl;
+    counters.report(cout, 26);
     cout << "\tResults found: " << count << endl;
 
     // Test 2: "a" as prefix
@@ -45,6 +104,7 @@ void testRuntime(string filename) {
     results = trie->predictCompletions("a", NUM_COMP);
     time = timer.end_timer();
     cout << "\tTime taken: " << time << " nanoseconds." << endl;
+    counters.report(cout, 1);
     cout << "\tResults found: " << results.size() << endl;
 
     // Test 3: "the" as prefix
@@ -53,6 +113,7 @@ void testRuntime(string filename) {
     results = trie->predictCompletions("the", NUM_COMP);
     time = timer.end_timer();
     cout << "\tTime taken: " << time << " nanoseconds." << endl;
+    counters.report(cout, 1);
     cout << "\tResults found: " << results.size() << endl;
 
     // Test 4: "app" as prefix
@@ -61,6 +122,7 @@ void testRuntime(string filename) {
     results = trie->predictCompletions("app", NUM_COMP);
     time = timer.end_timer();
     cout << "\tTime taken: " << time << " nanoseconds." << endl;
+    counters.report(cout, 1);
     cout << "\tResults found: " << results.size() << endl;
 
     // Test 5: "man" as prefix
@@ -69,8 +131,362 @@ void testRuntime(string filename) {
     results = trie->predictCompletions("man", NUM_COMP);
     time = timer.end_timer();
     cout << "\tTime taken: " << time << " nanoseconds." << endl;
+    counters.report(cout, 1);
     cout << "\tResults found: " << results.size() << endl;
 
+    // Test 6: Zipfian mix of prefixes, uncached and behind a ResultCache
+    const unsigned int NUM_QUERIES = 20000;
+    const unsigned int CACHE_SIZE = 1000;
+    vector<string> prefixes = zipfianPrefixes(filename, NUM_QUERIES);
+    cout << "\nTest 6: " << NUM_QUERIES << " Zipfian prefixes, "
+         << "numCompletions = " << NUM_COMP << endl;
+    timer.begin_timer();
+    count = 0;
+    for (unsigned int i = 0; i < prefixes.size(); i++) {
+        count += trie->predictCompletions(prefixes[i], NUM_COMP).size();
+    }
+    time = timer.end_timer();
+    cout << "\tUncached time taken: " << time << " nanoseconds." << endl;
+    counters.report(cout, prefixes.size());
+    cout << "\tResults found: " << count << endl;
+
+    CachedDictionary cached(*trie, CACHE_SIZE);
+    timer.begin_timer();
+    count = 0;
+    for (unsigned int i = 0; i < prefixes.size(); i++) {
+        count += cached.predictCompletions(prefixes[i], NUM_COMP).size();
+    }
+    time = timer.end_timer();
+    cout << "\tCached time taken: " << time << " nanoseconds." << endl;
+    counters.report(cout, prefixes.size());
+    cout << "\tResults found: " << count << endl;
+    cout << "\tCache hit rate: " << cached.getCache().hitRate() << endl;
+
+    // Test 7: succinct copy against the pointer based trie
+    cout << "\nTest 7: succinct trie, prefix = \"iterating through alphabet\""
+         << ", numCompletions = " << NUM_COMP << endl;
+    SuccinctTrie succinct(*trie);
+    TrieStats stats = trie->stats();
+    cout << "\tPointer trie bits per word: "
+         << stats.totalBytes() * 8.0 / max(1ull, stats.wordCount) << endl;
+    cout << "\tSuccinct trie bits per word: " << succinct.bitsPerWord()
+         << endl;
+    timer.begin_timer();
+    count = 0;
+    for (char c = 'a'; c <= 'z'; c++) {
+        count += trie->predictCompletions(string(1, c), NUM_COMP).size();
+    }
+    time = timer.end_timer();
+    cout << "\tPointer trie time taken: " << time << " nanoseconds." << endl;
+    counters.report(cout, 26);
+    cout << "\tResults found: " << count << endl;
+    timer.begin_timer();
+    count = 0;
+    for (char c = 'a'; c <= 'z'; c++) {
+        count += succinct.predictCompletions(string(1, c), NUM_COMP).size();
+    }
+    time = timer.end_timer();
+    cout << "\tSuccinct trie time taken: " << time << " nanoseconds."
+         << endl;
+    counters.report(cout, 26);
+    cout << "\tResults found: " << count << endl;
+
+    // Test 8: tries specialized on the lowercase alphabet
+    cout << "\nTest 8: alphabet trie, prefix = \"iterating through alphabet\""
+         << ", numCompletions = " << NUM_COMP << endl;
+    vector<pair<unsigned int, string>> words;
+    trie->collectWords(words);
+    AlphabetTrie<LowercaseAlphabet, DenseChildren> dense;
+    AlphabetTrie<LowercaseAlphabet, BitmapChildren> bitmap;
+    for (unsigned int i = 0; i < words.size(); i++) {
+        dense.insert(words[i].second, words[i].first);
+        bitmap.insert(words[i].second, words[i].first);
+    }
+    cout << "\tWords outside the alphabet: " << words.size() - dense.size()
+         << endl;
+    cout << "\tDense children bits per word: "
+         << dense.sizeInBytes() * 8.0 / max<size_t>(1, dense.size()) << endl;
+    cout << "\tBitmap children bits per word: "
+         << bitmap.sizeInBytes() * 8.0 / max<size_t>(1, bitmap.size())
+         << endl;
+    timer.begin_timer();
+    count = 0;
+    for (char c = 'a'; c <= 'z'; c++) {
+        count += dense.predictCompletions(string(1, c), NUM_COMP).size();
+    }
+    time = timer.end_timer();
+    cout << "\tDense children time taken: " << time << " nanoseconds."
+         << endl;
+    counters.report(cout, 26);
+    cout << "\tResults found: " << count << endl;
+    timer.begin_timer();
+    count = 0;
+    for (char c = 'a'; c <= 'z'; c++) {
+        count += bitmap.predictCompletions(string(1, c), NUM_COMP).size();
+    }
+    time = timer.end_timer();
+    cout << "\tBitmap children time taken: " << time << " nanoseconds."
+         << endl;
+    counters.report(cout, 26);
+    cout << "\tResults found: " << count << endl;
+
+    // Test 9: batched lookups against one find at a time
+    cout << "\nTest 9: find every word and every word minus its last letter"
+         << ", shuffled" << endl;
+    vector<string> queries;
+    for (unsigned int i = 0; i < words.size(); i++) {
+        queries.push_back(words[i].second);
+        queries.push_back(
+            words[i].second.substr(0, words[i].second.length() - 1));
+    }
+    mt19937 generator(100);
+    shuffle(queries.begin(), queries.end(), generator);
+    timer.begin_timer();
+    count = 0;
+    for (unsigned int i = 0; i < queries.size(); i++) {
+        count += trie->find(queries[i]);
+    }
+    time = timer.end_timer();
+    cout << "\tfind time taken: " << time << " nanoseconds." << endl;
+    counters.report(cout, queries.size());
+    cout << "\tResults found: " << count << endl;
+    for (unsigned int groupSize = 1; groupSize <= 32; groupSize *= 2) {
+        timer.begin_timer();
+        vector<bool> found = trie->findMany(queries, groupSize);
+        count = std::count(found.begin(), found.end(), true);
+        time = timer.end_timer();
+        cout << "\tfindMany group " << groupSize << " time taken: " << time
+             << " nanoseconds." << endl;
+        counters.report(cout, queries.size());
+        cout << "\tResults found: " << count << endl;
+    }
+
+    // Test 10: exact lookups through the hash index
+    cout << "\nTest 10: same lookups as Test 9, trie walk against index"
+         << endl;
+    for (unsigned int indexed = 0; indexed <= 1; indexed++) {
+        if (indexed) {
+            trie->buildIndex();
+        }
+        timer.begin_timer();
+        count = 0;
+        for (unsigned int i = 0; i < queries.size(); i++) {
+            count += trie->find(queries[i]);
+        }
+        time = timer.end_timer();
+        cout << (indexed ? "\tIndexed" : "\tTrie walk")
+             << " find time taken: " << time << " nanoseconds." << endl;
+        counters.report(cout, queries.size());
+        cout << "\tResults found: " << count << endl;
+    }
+    cout << "\tIndex bytes: " << trie->stats().indexBytes << endl;
+
+    // Test 11: paging through completions, recomputed against resumed
+    const unsigned int NUM_PAGES = 10;
+    cout << "\nTest 11: prefix = \"a\", " << NUM_PAGES << " pages of "
+         << NUM_COMP << " completions" << endl;
+    timer.begin_timer();
+    count = trie->countPrefix("a");
+    time = timer.end_timer();
+    cout << "\tcountPrefix time taken: " << time << " nanoseconds." << endl;
+    cout << "\tMatches: " << count << endl;
+    timer.begin_timer();
+    count = 0;
+    for (unsigned int page = 1; page <= NUM_PAGES; page++) {
+        results = trie->predictCompletions("a", page * NUM_COMP);
+        count += results.size() - (page - 1) * NUM_COMP;
+    }
+    time = timer.end_timer();
+    cout << "\tRecomputed pages time taken: " << time << " nanoseconds."
+         << endl;
+    counters.report(cout, NUM_PAGES);
+    cout << "\tResults found: " << count << endl;
+    timer.begin_timer();
+    count = 0;
+    DictionaryTrie::CompletionIterator pages = trie->completions("a");
+    for (unsigned int page = 1; page <= NUM_PAGES; page++) {
+        count += pages.nextPage(NUM_COMP).size();
+    }
+    time = timer.end_timer();
+    cout << "\tResumed pages time taken: " << time << " nanoseconds."
+         << endl;
+    counters.report(cout, NUM_PAGES);
+    cout << "\tResults found: " << count << endl;
+
+    // Test 12: fragments from the middle of words, scanned and indexed
+    vector<string> fragments = {"ork", "tion", "ing", "xyl", "ville", "q"};
+    cout << "\nTest 12: " << fragments.size()
+         << " infix fragments, numCompletions = " << NUM_COMP << endl;
+    for (unsigned int indexed = 0; indexed <= 1; indexed++) {
+        if (indexed) {
+            timer.begin_timer();
+            trie->buildInfixIndex();
+            time = timer.end_timer();
+            cout << "\tIndex build time taken: " << time << " nanoseconds."
+                 << endl;
+        }
+        timer.begin_timer();
+        count = 0;
+        for (unsigned int i = 0; i < fragments.size(); i++) {
+            count += trie->predictInfix(fragments[i], NUM_COMP).size();
+        }
+        time = timer.end_timer();
+        cout << (indexed ? "\tIndexed" : "\tScanned")
+             << " time taken: " << time << " nanoseconds." << endl;
+        counters.report(cout, fragments.size());
+        cout << "\tResults found: " << count << endl;
+    }
+    cout << "\tInfix index bytes: " << trie->stats().infixBytes << endl;
+
+    // Test 13: expensive queries, unbounded against a node budget
+    const unsigned long long MAX_VISITS = 20000;
+    vector<string> expensive = {"a", "s", "t", "_____", "__________"};
+    cout << "\nTest 13: " << expensive.size()
+         << " one letter prefixes and underscore patterns, budget = "
+         << MAX_VISITS << " nodes" << endl;
+    for (unsigned int bounded = 0; bounded <= 1; bounded++) {
+        timer.begin_timer();
+        count = 0;
+        unsigned int incomplete = 0;
+        for (unsigned int i = 0; i < expensive.size(); i++) {
+            QueryBudget budget(bounded ? MAX_VISITS : 0);
+            bool pattern = expensive[i].find('_') != string::npos;
+            if (pattern && bounded) {
+                results = trie->predictUnderscores(expensive[i], NUM_COMP,
+                                                   budget);
+            } else if (pattern) {
+                results = trie->predictUnderscores(expensive[i], NUM_COMP);
+            } else if (bounded) {
+                results = trie->predictCompletions(expensive[i], NUM_COMP,
+                                                   budget);
+            } else {
+                results = trie->predictCompletions(expensive[i], NUM_COMP);
+            }
+            count += results.size();
+            incomplete += budget.exhausted;
+        }
+        time = timer.end_timer();
+        cout << (bounded ? "\tBudgeted" : "\tUnbounded")
+             << " time taken: " << time << " nanoseconds." << endl;
+        counters.report(cout, expensive.size());
+        cout << "\tResults found: " << count << endl;
+        cout << "\tIncomplete answers: " << incomplete << endl;
+    }
+
+    // Test 14: a batch of puzzle patterns, one by one and in one walk
+    vector<string> patterns;
+    for (unsigned int i = 0; i < words.size() && patterns.size() < 500;
+         i += 97) {
+        string pattern = words[i].second;
+        if (pattern.length() < 4) {
+            continue;
+        }
+        for (unsigned int j = 0; j < pattern.length(); j++) {
+            if (generator() % 2 == 0) {
+                pattern[j] = '_';
+            }
+        }
+        patterns.push_back(pattern);
+    }
+    cout << "\nTest 14: " << patterns.size()
+         << " underscore patterns, numCompletions = " << NUM_COMP << endl;
+    timer.begin_timer();
+    count = 0;
+    for (unsigned int i = 0; i < patterns.size(); i++) {
+        count += trie->predictUnderscores(patterns[i], NUM_COMP).size();
+    }
+    time = timer.end_timer();
+    cout << "\tOne by one time taken: " << time << " nanoseconds." << endl;
+    counters.report(cout, patterns.size());
+    cout << "\tResults found: " << count << endl;
+    timer.begin_timer();
+    count = 0;
+    vector<vector<string>> answers =
+        trie->predictUnderscoresMany(patterns, NUM_COMP);
+    for (unsigned int i = 0; i < answers.size(); i++) {
+        count += answers[i].size();
+    }
+    time = timer.end_timer();
+    cout << "\tShared walk time taken: " << time << " nanoseconds." << endl;
+    counters.report(cout, patterns.size());
+    cout << "\tResults found: " << count << endl;
+
+    // Test 15: time to the first answers, whole file against lazy letters
+    cout << "\nTest 15: load and answer prefix = \"app\", numCompletions = "
+         << NUM_COMP << endl;
+    timer.begin_timer();
+    {
+        ifstream eagerIn(filename, ios::binary);
+        DictionaryTrie eager;
+        Utils::loadDict(eager, eagerIn);
+        count = eager.predictCompletions("app", NUM_COMP).size();
+        time = timer.end_timer();
+    }
+    cout << "\tloadDict time taken: " << time << " nanoseconds." << endl;
+    cout << "\tResults found: " << count << endl;
+    timer.begin_timer();
+    {
+        LazyDictionary lazy;
+        lazy.open(filename);
+        count = lazy.predictCompletions("app", NUM_COMP).size();
+        time = timer.end_timer();
+        cout << "\tLazy time taken: " << time << " nanoseconds." << endl;
+        cout << "\tResults found: " << count << endl;
+        cout << "\tLetters built: " << lazy.builtLetters() << endl;
+    }
+
+    // Test 16: the same load and queries on every dictionary engine
+    cout << "\nTest 16: dictionary engines side by side, numCompletions = "
+         << NUM_COMP << endl;
+    for (unsigned int e = 0; e < engines.size(); e++) {
+        DictionaryEngine* engine = Utils::newEngine(engines[e]);
+        cout << "\tEngine: " << engines[e] << endl;
+
+        // parsing, then the engine's own bulk insert
+        ifstream engineIn(filename, ios::binary);
+        timer.begin_timer();
+        vector<pair<unsigned int, string>> engineWords;
+        Utils::loadDict(engineWords, engineIn);
+        count = engine->insertAll(engineWords);
+        time = timer.end_timer();
+        printTiming("Load", time, counters, 1, count);
+
+        timer.begin_timer();
+        count = 0;
+        for (char c = 'a'; c <= 'z'; c++) {
+            count += engine->predictCompletions(string(1, c), NUM_COMP).size();
+        }
+        time = timer.end_timer();
+        printTiming("Alphabet prefixes", time, counters, 26, count);
+
+        timer.begin_timer();
+        count = 0;
+        for (unsigned int i = 0; i < prefixes.size(); i++) {
+            count += engine->predictCompletions(prefixes[i], NUM_COMP).size();
+        }
+        time = timer.end_timer();
+        printTiming("Zipfian prefixes", time, counters, prefixes.size(),
+                    count);
+
+        timer.begin_timer();
+        count = 0;
+        for (unsigned int i = 0; i < queries.size(); i++) {
+            count += engine->find(queries[i]);
+        }
+        time = timer.end_timer();
+        printTiming("find", time, counters, queries.size(), count);
+
+        timer.begin_timer();
+        count = 0;
+        for (unsigned int i = 0; i < patterns.size(); i++) {
+            count += engine->predictUnderscores(patterns[i], NUM_COMP).size();
+        }
+        time = timer.end_timer();
+        printTiming("Underscore patterns", time, counters, patterns.size(),
+                    count);
+        delete engine;
+    }
+
     // Addtional tests
     cout << "\nWould you like to run additional tests? (y/n) ";
     string response;
@@ -93,6 +509,7 @@ void testRuntime(string filename) {
             results = trie->predictCompletions(prefix, numCompletions);
             time = timer.end_timer();
             cout << "\tTime taken: " << time << " nanoseconds." << endl;
+            counters.report(cout, 1);
             cout << "\tResults found: " << results.size() << "\n\n";
             cout << "Enter prefix: ";
         }
@@ -124,14 +541,29 @@ bool fileValid(const char* fileName) {
 
 /* The main function that drives the program */
 int main(int argc, char* argv[]) {
-    const int NUM_ARG = 2;
-
-    if (argc != NUM_ARG) {
+    // --perf adds hardware counters to every timing, --engine compares
+    // only that dictionary engine in Test 16 instead of all of them
+    bool perf = false;
+    vector<string> engines = Utils::ENGINE_NAMES;
+    bool valid = argc >= 2;
+    for (int i = 2; i < argc && valid; i++) {
+        if (string(argv[i]) == "--perf") {
+            perf = true;
+        } else if (string(argv[i]) == "--engine" && i + 1 < argc &&
+                   find(Utils::ENGINE_NAMES.begin(), Utils::ENGINE_NAMES.end(),
+                        argv[i + 1]) != Utils::ENGINE_NAMES.end()) {
+            engines = vector<string>(1, argv[++i]);
+        } else {
+            valid = false;
+        }
+    }
+    if (!valid) {
         cout << "Invalid number of arguments.\n"
-             << "Usage: ./benchtrie <dictionary filename>" << endl;
+             << "Usage: ./benchtrie <dictionary filename> [--perf] "
+             << "[--engine trie|sorted]" << endl;
         return -1;
     }
 
     if (!fileValid(argv[1])) return -1;
-    testRuntime(argv[1]);
+    testRuntime(argv[1], perf, engines);
 }
\ No newline at end of file
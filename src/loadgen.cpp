@@ -0,0 +1,212 @@
+/**
+ * Replays a query log against a loaded DictionaryTrie from several
+ * threads to measure throughput and tail latency before rollout.
+ *
+ * Each line of the query log is "<numCompletions> <prefix or pattern>",
+ * the same layout as the dictionary files. Patterns containing an
+ * underscore go to predictUnderscores, everything else goes to
+ * predictCompletions.
+ *
+ * closed: every thread sends its next query as soon as the previous one
+ *         returns, latency is the service time of each query.
+ * open:   queries are scheduled at a fixed arrival rate, latency is
+ *         measured from the scheduled start so that time spent waiting
+ *         behind a slow query is counted (no coordinated omission).
+ */
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <thread>
+#include "DictionaryTrie.hpp"
+#include "util.hpp"
+using namespace std;
+
+typedef chrono::steady_clock Clock;
+typedef vector<pair<unsigned int, string>> QueryList;
+
+/* Runs a single query against the trie, returns the number of results */
+unsigned int runQuery(const DictionaryTrie& trie,
+                      const pair<unsigned int, string>& query) {
+    if (query.second.find('_') != string::npos) {
+        return trie.predictUnderscores(query.second, query.first).size();
+    }
+    return trie.predictCompletions(query.second, query.first).size();
+}
+
+/* Worker for the closed loop, replays queries thread, thread + threads...
+ * and records the service time of each
+ */
+void closedLoop(const DictionaryTrie& trie, const QueryList& queries,
+                unsigned int thread, unsigned int numThreads,
+                vector<long long>& latencies,
+                atomic<unsigned long long>& results) {
+    unsigned long long found = 0;
+    for (unsigned int i = thread; i < queries.size(); i += numThreads) {
+        Clock::time_point start = Clock::now();
+        found += runQuery(trie, queries[i]);
+        latencies.push_back(
+            chrono::duration_cast<chrono::nanoseconds>(Clock::now() - start)
+                .count());
+    }
+    results += found;
+}
+
+/* Worker for the open loop, query i is due at begin + i * interval and its
+ * latency runs from that due time, not from when the thread got to it.
+ * Every thread takes the next query due from the shared counter next, so
+ * while one thread is held up by a slow query the others take over the
+ * queries falling due, as one server with numThreads workers would
+ */
+void openLoop(const DictionaryTrie& trie, const QueryList& queries,
+              atomic<unsigned int>& next, Clock::time_point begin,
+              chrono::nanoseconds interval, vector<long long>& latencies,
+              atomic<unsigned long long>& results) {
+    unsigned long long found = 0;
+    for (unsigned int i = next++; i < queries.size(); i = next++) {
+        Clock::time_point due = begin + interval * i;
+        this_thread::sleep_until(due);
+        found += runQuery(trie, queries[i]);
+        latencies.push_back(
+            chrono::duration_cast<chrono::nanoseconds>(Clock::now() - due)
+                .count());
+    }
+    results += found;
+}
+
+/* Returns the latency below which the given fraction of queries fall
+ * PRECONDITION: latencies is sorted and not empty
+ */
+long long percentile(const vector<long long>& latencies, double fraction) {
+    unsigned int index = (unsigned int)(fraction * (latencies.size() - 1));
+    return latencies[index];
+}
+
+/* Prints throughput and the latency distribution of a run */
+void printReport(vector<long long>& latencies, long long elapsed,
+                 unsigned long long results) {
+    sort(latencies.begin(), latencies.end());
+
+    cout << "\nQueries: " << latencies.size() << endl;
+    cout << "Results found: " << results << endl;
+    cout << "Elapsed: " << elapsed << " nanoseconds." << endl;
+    cout << "Throughput: " << fixed << setprecision(0)
+         << latencies.size() / (elapsed / 1e9) << " queries/second" << endl;
+
+    if (latencies.empty()) {
+        return;
+    }
+    cout << "\nLatency (nanoseconds)" << endl;
+    cout << "\tp50: " << percentile(latencies, 0.50) << endl;
+    cout << "\tp90: " << percentile(latencies, 0.90) << endl;
+    cout << "\tp99: " << percentile(latencies, 0.99) << endl;
+    cout << "\tp99.9: " << percentile(latencies, 0.999) << endl;
+    cout << "\tmax: " << latencies.back() << endl;
+}
+
+/* Check if a given data file is valid */
+bool fileValid(const char* fileName) {
+    ifstream in;
+    in.open(fileName, ios::binary);
+
+    // Check if input file was actually opened
+    if (!in.is_open()) {
+        cout << "Invalid input file. No file was opened. Please try again.\n";
+        return false;
+    }
+
+    // Check for empty file
+    in.seekg(0, ios_base::end);
+    unsigned int len = in.tellg();
+    if (len == 0) {
+        cout << "The file is empty. \n";
+        return false;
+    }
+    in.close();
+    return true;
+}
+
+/* The main function that drives the program */
+int main(int argc, char* argv[]) {
+    if (argc < 5 || argc > 6) {
+        cout << "Invalid number of arguments.\n"
+             << "Usage: ./loadgen <dictionary filename> <query log> "
+             << "<threads> closed\n"
+             << "       ./loadgen <dictionary filename> <query log> "
+             << "<threads> open <queries/second>" << endl;
+        return -1;
+    }
+
+    if (!fileValid(argv[1]) || !fileValid(argv[2])) return -1;
+
+    int numThreads = atoi(argv[3]);
+    string mode = argv[4];
+    double rate = argc == 6 ? atof(argv[5]) : 0;
+    if (numThreads <= 0 || (mode != "closed" && mode != "open") ||
+        (mode == "open" && rate <= 0) || (mode == "closed" && argc != 5)) {
+        cout << "Invalid arguments." << endl;
+        return -1;
+    }
+
+    cout << "Reading file: " << argv[1] << endl;
+    ifstream in;
+    in.open(argv[1], ios::binary);
+    DictionaryTrie trie;
+    Utils::loadDict(trie, in);
+    in.close();
+
+    // query logs share the "<number> <words>" layout of dictionary files
+    cout << "Reading query log: " << argv[2] << endl;
+    QueryList queries;
+    in.open(argv[2], ios::binary);
+    Utils::loadDict(queries, in);
+    in.close();
+    queries.erase(remove_if(queries.begin(), queries.end(),
+                            [](const pair<unsigned int, string>& query) {
+                                return query.second.empty();
+                            }),
+                  queries.end());
+
+    cout << "Replaying " << queries.size() << " queries from " << numThreads
+         << " threads, " << mode << " loop";
+    if (mode == "open") {
+        cout << " at " << rate << " queries/second";
+    }
+    cout << endl;
+
+    vector<vector<long long>> latencies(numThreads);
+    vector<thread> workers;
+    atomic<unsigned long long> results(0);
+    atomic<unsigned int> next(0);  // next query due, for the open loop
+    chrono::nanoseconds interval((long long)(1e9 / max(rate, 1e-9)));
+
+    Clock::time_point begin = Clock::now();
+    for (int i = 0; i < numThreads; i++) {
+        if (mode == "closed") {
+            workers.push_back(thread(closedLoop, cref(trie), cref(queries), i,
+                                     numThreads, ref(latencies[i]),
+                                     ref(results)));
+        } else {
+            workers.push_back(thread(openLoop, cref(trie), cref(queries),
+                                     ref(next), begin, interval,
+                                     ref(latencies[i]), ref(results)));
+        }
+    }
+    for (unsigned int i = 0; i < workers.size(); i++) {
+        workers[i].join();
+    }
+    long long elapsed =
+        chrono::duration_cast<chrono::nanoseconds>(Clock::now() - begin)
+            .count();
+
+    vector<long long> allLatencies;
+    for (unsigned int i = 0; i < latencies.size(); i++) {
+        allLatencies.insert(allLatencies.end(), latencies[i].begin(),
+                            latencies[i].end());
+    }
+    printReport(allLatencies, elapsed, results);
+    return 0;
+}
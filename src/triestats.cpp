@@ -0,0 +1,172 @@
+/**
+ * Reports the memory footprint and shape of a DictionaryTrie built
+ * from a dictionary file, so that loaders and build orders can be
+ * compared on real data.
+ */
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <random>
+#include <sstream>
+#include <thread>
+#include "DictionaryTrie.hpp"
+#include "util.hpp"
+using namespace std;
+
+typedef vector<pair<unsigned int, string>> WordList;
+
+/* Insert the words in [begin, end) median first so every left/right
+ * subtree gets built from the middle of its alphabetical range
+ */
+void insertBalanced(DictionaryTrie& trie, const WordList& words,
+                    unsigned int begin, unsigned int end) {
+    if (begin >= end) {
+        return;
+    }
+    unsigned int mid = begin + (end - begin) / 2;
+    trie.insert(words[mid].second, words[mid].first);
+    insertBalanced(trie, words, begin, mid);
+    insertBalanced(trie, words, mid + 1, end);
+}
+
+/* Builds the trie inserting the words in the given order */
+bool buildTrie(DictionaryTrie& trie, WordList& words, const string& order) {
+    if (order == "file") {
+        // keep the order of the input file
+    } else if (order == "sorted") {
+        sort(words.begin(), words.end(),
+             [](const pair<unsigned int, string>& p1,
+                const pair<unsigned int, string>& p2) {
+                 return p1.second < p2.second;
+             });
+    } else if (order == "shuffled") {
+        shuffle(words.begin(), words.end(), mt19937(100));
+    } else if (order == "balanced") {
+        sort(words.begin(), words.end(),
+             [](const pair<unsigned int, string>& p1,
+                const pair<unsigned int, string>& p2) {
+                 return p1.second < p2.second;
+             });
+        insertBalanced(trie, words, 0, words.size());
+        return true;
+    } else {
+        return false;
+    }
+
+    for (unsigned int i = 0; i < words.size(); i++) {
+        trie.insert(words[i].second, words[i].first);
+    }
+    return true;
+}
+
+/* Prints the stats of the trie */
+void printStats(const TrieStats& stats, long long buildTime) {
+    cout << "\nBuild time: " << buildTime << " nanoseconds." << endl;
+
+    cout << "\nCounts" << endl;
+    cout << "\tNodes: " << stats.nodeCount << endl;
+    cout << "\tWords: " << stats.wordCount << endl;
+    if (stats.wordCount > 0) {
+        cout << "\tNodes per word: " << fixed << setprecision(2)
+             << (double)stats.nodeCount / stats.wordCount << endl;
+    }
+
+    cout << "\nMemory (bytes)" << endl;
+    cout << "\tTotal: " << stats.totalBytes() << endl;
+    cout << "\tTrie object: " << stats.objectBytes << endl;
+    cout << "\tNodes: " << stats.nodeBytes << endl;
+    cout << "\t  pointers: " << stats.pointerBytes << endl;
+    cout << "\t  labels: " << stats.labelBytes << endl;
+    cout << "\t  frequencies: " << stats.frequencyBytes << endl;
+    cout << "\t  word counts: " << stats.countBytes << endl;
+    cout << "\t  padding: " << stats.paddingBytes << endl;
+    if (stats.wordCount > 0) {
+        cout << "\tBytes per word: " << fixed << setprecision(2)
+             << (double)stats.totalBytes() / stats.wordCount << endl;
+    }
+
+    cout << "\nSearch depth (nodes visited by find)" << endl;
+    cout << "\tAverage: " << fixed << setprecision(2)
+         << stats.averageSearchDepth() << endl;
+    cout << "\tMax: " << stats.maxSearchDepth << endl;
+
+    cout << "\nLeft/right imbalance per level" << endl;
+    cout << "\tlevel\tnodes\tleft\tright\tavg\tmax" << endl;
+    for (unsigned int i = 0; i < stats.levels.size(); i++) {
+        const TrieStats::LevelStats& level = stats.levels[i];
+        cout << "\t" << i << "\t" << level.nodes << "\t" << level.leftLinks
+             << "\t" << level.rightLinks << "\t" << fixed << setprecision(2)
+             << (double)level.totalImbalance / level.nodes << "\t"
+             << level.maxImbalance << endl;
+    }
+
+    cout << "\nFan-out distribution (distinct next letters per node)" << endl;
+    cout << "\tfan-out\tnodes" << endl;
+    for (unsigned int i = 0; i < stats.fanOut.size(); i++) {
+        if (stats.fanOut[i] > 0) {
+            cout << "\t" << i << "\t" << stats.fanOut[i] << endl;
+        }
+    }
+}
+
+/* Check if a given data file is valid */
+bool fileValid(const char* fileName) {
+    ifstream in;
+    in.open(fileName, ios::binary);
+
+    // Check if input file was actually opened
+    if (!in.is_open()) {
+        cout << "Invalid input file. No file was opened. Please try again.\n";
+        return false;
+    }
+
+    // Check for empty file
+    in.seekg(0, ios_base::end);
+    unsigned int len = in.tellg();
+    if (len == 0) {
+        cout << "The file is empty. \n";
+        return false;
+    }
+    in.close();
+    return true;
+}
+
+/* The main function that drives the program */
+int main(int argc, char* argv[]) {
+    if (argc != 2 && argc != 3) {
+        cout << "Invalid number of arguments.\n"
+             << "Usage: ./triestats <dictionary filename> "
+             << "[file|sorted|shuffled|balanced|parallel]" << endl;
+        return -1;
+    }
+
+    if (!fileValid(argv[1])) return -1;
+    string order = argc == 3 ? argv[2] : "file";
+
+    ifstream in;
+    in.open(argv[1], ios::binary);
+    WordList words;
+    Utils::loadDict(words, in);
+    in.close();
+
+    cout << "Reading file: " << argv[1] << endl;
+    cout << "Build order: " << order << endl;
+
+    DictionaryTrie trie;
+    Timer timer;
+    timer.begin_timer();
+    if (order == "parallel") {
+        // time the whole parallel loader, parsing included
+        in.open(argv[1], ios::binary);
+        Utils::loadDictParallel(trie, in,
+                                max(1u, thread::hardware_concurrency()));
+        in.close();
+    } else if (!buildTrie(trie, words, order)) {
+        cout << "Unknown build order: " << order << endl;
+        return -1;
+    }
+    long long time = timer.end_timer();
+
+    printStats(trie.stats(), time);
+    return 0;
+}
@@ -0,0 +1,27 @@
+/**
+ * This file defines the generated dictionary several test files fill
+ * their dictionaries with
+ */
+#ifndef GENERATED_WORDS_HPP
+#define GENERATED_WORDS_HPP
+
+#include <string>
+#include "DictionaryEngine.hpp"
+
+using namespace std;
+
+/* words of three to six letters from a to e, in no particular order,
+ * with distinct frequencies so the best words are never tied
+ */
+inline void fillGenerated(DictionaryEngine& dict) {
+    for (unsigned int i = 0; i < 3000; i++) {
+        string word;
+        for (unsigned int n = i * 7919 % 100003; word.length() < 3 || n > 0;
+             n /= 5) {
+            word.push_back('a' + n % 5);
+        }
+        dict.insert(word.substr(0, 6), i + 1);
+    }
+}
+
+#endif  // GENERATED_WORDS_HPP
@@ -0,0 +1,101 @@
+/**
+ * This File contains several tests
+ * that check the functionality of the
+ * AlphabetTrie with both node policies
+ */
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "AlphabetTrie.hpp"
+#include "DictionaryTrie.hpp"
+
+using namespace std;
+using namespace testing;
+
+typedef AlphabetTrie<LowercaseAlphabet, DenseChildren> DenseTrie;
+typedef AlphabetTrie<LowercaseAlphabet, BitmapChildren> BitmapTrie;
+
+/* inserts the same words in both tries */
+template <class Trie>
+void fill(Trie& trie, DictionaryTrie& dict) {
+    vector<pair<unsigned int, string>> words = {
+        {5, "apple"},    {4, "appendage"}, {3, "ape"},  {2, "apparent"},
+        {69, "tired"},   {420, "sad"},     {9000, "deez"},
+        {5000, "nuts"},  {1, "ap"},        {7, "the big apple"},
+        {6, "don't"}};
+    for (unsigned int i = 0; i < words.size(); i++) {
+        trie.insert(words[i].second, words[i].first);
+        dict.insert(words[i].second, words[i].first);
+    }
+}
+
+/* ALPHABET TESTS */
+TEST(AlphabetTrieTests, ALPHABET) {
+    static_assert(LowercaseAlphabet::index('a') == 0, "a is index 0");
+    static_assert(LowercaseAlphabet::index('z') == 25, "z is index 25");
+    static_assert(LowercaseAlphabet::index('A') == -1, "A is not a symbol");
+    for (unsigned int i = 0; i < LowercaseAlphabet::SIZE; i++) {
+        ASSERT_EQ(LowercaseAlphabet::index(LowercaseAlphabet::symbol(i)),
+                  (int)i);
+    }
+}
+
+/* INSERT AND FIND TESTS */
+TEST(AlphabetTrieTests, INSERT_FIND) {
+    DenseTrie trie;
+    ASSERT_EQ(trie.find("apple"), false);
+    ASSERT_EQ(trie.insert("apple", 5), true);
+    ASSERT_EQ(trie.insert("apple", 6), false);
+    ASSERT_EQ(trie.insert("app", 2), true);
+    ASSERT_EQ(trie.find("apple"), true);
+    ASSERT_EQ(trie.find("app"), true);
+    ASSERT_EQ(trie.find("ap"), false);
+    ASSERT_EQ(trie.find("apples"), false);
+    ASSERT_EQ(trie.size(), 2);
+    ASSERT_EQ(trie.nodeCount(), 6);
+}
+TEST(AlphabetTrieTests, REJECTS_OUTSIDE_ALPHABET) {
+    BitmapTrie trie;
+    ASSERT_EQ(trie.insert("Apple", 5), false);
+    ASSERT_EQ(trie.insert("caf\xc3\xa9", 5), false);
+    ASSERT_EQ(trie.insert("", 5), false);
+    ASSERT_EQ(trie.insert("apple", 0), false);
+    ASSERT_EQ(trie.size(), 0);
+    ASSERT_EQ(trie.find("Apple"), false);
+    ASSERT_EQ(trie.predictCompletions("A", 3), vector<string>());
+}
+
+/* PREDICT TESTS */
+TEST(AlphabetTrieTests, DENSE_MATCHES_DICTIONARY_TRIE) {
+    DenseTrie trie;
+    DictionaryTrie dict;
+    fill(trie, dict);
+    for (unsigned int k = 0; k <= 8; k++) {
+        ASSERT_EQ(trie.predictCompletions("ap", k),
+                  dict.predictCompletions("ap", k));
+        ASSERT_EQ(trie.predictCompletions("t", k),
+                  dict.predictCompletions("t", k));
+        ASSERT_EQ(trie.predictUnderscores("a__", k),
+                  dict.predictUnderscores("a__", k));
+        ASSERT_EQ(trie.predictUnderscores("_____", k),
+                  dict.predictUnderscores("_____", k));
+    }
+}
+TEST(AlphabetTrieTests, BITMAP_MATCHES_DICTIONARY_TRIE) {
+    BitmapTrie trie;
+    DictionaryTrie dict;
+    fill(trie, dict);
+    for (unsigned int k = 0; k <= 8; k++) {
+        ASSERT_EQ(trie.predictCompletions("ap", k),
+                  dict.predictCompletions("ap", k));
+        ASSERT_EQ(trie.predictCompletions("don", k),
+                  dict.predictCompletions("don", k));
+        ASSERT_EQ(trie.predictUnderscores("d___", k),
+                  dict.predictUnderscores("d___", k));
+        ASSERT_EQ(trie.predictUnderscores("_pp__", k),
+                  dict.predictUnderscores("_pp__", k));
+    }
+    ASSERT_LT(trie.sizeInBytes(), DenseTrie().sizeInBytes() * 40);
+}
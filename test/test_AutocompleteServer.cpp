@@ -0,0 +1,150 @@
+/**
+ * This File contains several tests
+ * that check the functionality of the
+ * AutocompleteServer
+ */
+
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "AutocompleteServer.hpp"
+#include "DictionaryTrie.hpp"
+
+using namespace std;
+using namespace testing;
+
+/* small dictionary shared by the tests */
+static void fillDict(DictionaryTrie& dict) {
+    dict.insert("apple", 5);
+    dict.insert("appendage", 4);
+    dict.insert("ape", 3);
+    dict.insert("bij", 5);
+    dict.insert("boj", 4);
+    dict.insert("the big apple", 7);
+}
+
+/* sends every request at once, then reads until the server hangs up */
+static string roundTrip(const string& path, const string& requests) {
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    sockaddr_un address;
+    memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    if (connect(fd, (sockaddr*)&address, sizeof(address)) < 0) {
+        close(fd);
+        return "connect failed";
+    }
+
+    size_t sent = 0;
+    while (sent < requests.size()) {
+        ssize_t bytes = write(fd, requests.data() + sent,
+                              requests.size() - sent);
+        if (bytes <= 0) break;
+        sent += bytes;
+    }
+    shutdown(fd, SHUT_WR);
+
+    string responses;
+    char buffer[4096];
+    ssize_t bytes;
+    while ((bytes = read(fd, buffer, sizeof(buffer))) > 0) {
+        responses.append(buffer, bytes);
+    }
+    close(fd);
+    return responses;
+}
+
+/* ANSWER TESTS */
+TEST(AutocompleteServerTests, ANSWER) {
+    DictionaryTrie dict;
+    fillDict(dict);
+    ASSERT_EQ(AutocompleteServer::answer(dict, "2 ap"), "apple\tappendage");
+    ASSERT_EQ(AutocompleteServer::answer(dict, "5 b_j"), "bij\tboj");
+    ASSERT_EQ(AutocompleteServer::answer(dict, "1 the b"), "the big apple");
+    ASSERT_EQ(AutocompleteServer::answer(dict, "3 zz"), "");
+    ASSERT_EQ(AutocompleteServer::answer(dict, "ap"), "");
+    ASSERT_EQ(AutocompleteServer::answer(dict, "x ap"), "");
+}
+
+TEST(AutocompleteServerTests, ANSWER_WITHIN_BUDGET) {
+    DictionaryTrie dict;
+    fillDict(dict);
+    ASSERT_EQ(AutocompleteServer::answer(dict, "2 ap", 1000),
+              "apple\tappendage");
+    ASSERT_EQ(AutocompleteServer::answer(dict, "5 b_j", 1000), "bij\tboj");
+    // out of budget, a trailing tab marks the answer incomplete
+    string partial = AutocompleteServer::answer(dict, "3 ap", 2);
+    ASSERT_EQ(partial.back(), '\t');
+    ASSERT_EQ(AutocompleteServer::answer(dict, "5 ___", 2).back(), '\t');
+}
+
+/* SOCKET TESTS */
+TEST(AutocompleteServerTests, PIPELINED_REQUESTS_IN_ORDER) {
+    DictionaryTrie dict;
+    fillDict(dict);
+    string path = "/tmp/test_autocomplete_server_" + to_string(getpid());
+    AutocompleteServer server(dict, 3);
+    ASSERT_EQ(server.listen(path), true);
+    thread serving(&AutocompleteServer::run, &server);
+
+    string requests;
+    string expected;
+    for (unsigned int i = 0; i < 200; i++) {
+        requests += "2 ap\n3 b_j\nbad\n1 t\n";
+        expected += "apple\tappendage\nbij\tboj\n\nthe big apple\n";
+    }
+    ASSERT_EQ(roundTrip(path, requests), expected);
+
+    // several clients at once
+    vector<string> results(4);
+    vector<thread> clients;
+    for (unsigned int i = 0; i < results.size(); i++) {
+        clients.push_back(thread([&, i]() {
+            results[i] = roundTrip(path, requests);
+        }));
+    }
+    for (unsigned int i = 0; i < clients.size(); i++) {
+        clients[i].join();
+        ASSERT_EQ(results[i], expected);
+    }
+
+    server.stop();
+    serving.join();
+}
+TEST(AutocompleteServerTests, CLIENT_HANGS_UP) {
+    DictionaryTrie dict;
+    fillDict(dict);
+    string path = "/tmp/test_autocomplete_server_" + to_string(getpid());
+    AutocompleteServer server(dict, 2);
+    ASSERT_EQ(server.run(), false);  // not listening yet
+    ASSERT_EQ(server.listen(path), true);
+    thread serving(&AutocompleteServer::run, &server);
+
+    // clients that leave before reading their answers
+    for (unsigned int i = 0; i < 20; i++) {
+        int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un address;
+        memset(&address, 0, sizeof(address));
+        address.sun_family = AF_UNIX;
+        strncpy(address.sun_path, path.c_str(),
+                sizeof(address.sun_path) - 1);
+        ASSERT_EQ(connect(fd, (sockaddr*)&address, sizeof(address)), 0);
+        string requests;
+        for (unsigned int j = 0; j < 100; j++) {
+            requests += "3 ___\n";
+        }
+        ASSERT_EQ(write(fd, requests.data(), requests.size()),
+                  (ssize_t)requests.size());
+        close(fd);
+    }
+    ASSERT_EQ(roundTrip(path, "2 ap\n"), "apple\tappendage\n");
+
+    server.stop();
+    serving.join();
+}
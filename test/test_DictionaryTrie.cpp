@@ -11,11 +11,14 @@
 #include <fstream>
 #include <iostream>
 #include <set>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include <gtest/gtest.h>
 #include "DictionaryTrie.hpp"
+#include "GeneratedWords.hpp"
 #include "util.hpp"
 
 using namespace std;
@@ -46,6 +49,53 @@ TEST(DictTrieTests, INSERT_MULTIPLE) {
     ASSERT_EQ(dict.find("apple"), true);
 }
 
+TEST(DictTrieTests, FIND_MANY_MATCHES_FIND) {
+    DictionaryTrie dict;
+    vector<string> words = {"apple", "ape", "app", "the big apple",
+                            "sad", "deez", "nuts", "zebra"};
+    for (unsigned int i = 0; i < words.size(); i++) {
+        dict.insert(words[i], i + 1);
+    }
+    vector<string> queries = {"apple", "ap",   "",     "apples", "nuts",
+                              "zebra", "a",    "sad",  "the big apple",
+                              "the",   "deez", "dee",  "ape",    "q"};
+    vector<bool> expected;
+    for (unsigned int i = 0; i < queries.size(); i++) {
+        expected.push_back(queries[i] != "" && dict.find(queries[i]));
+    }
+    for (unsigned int groupSize = 0; groupSize <= 20; groupSize++) {
+        ASSERT_EQ(dict.findMany(queries, groupSize), expected);
+    }
+    ASSERT_EQ(DictionaryTrie().findMany(queries), vector<bool>(14, false));
+    ASSERT_EQ(dict.findMany(vector<string>()), vector<bool>());
+}
+
+TEST(DictTrieTests, INDEX_STAYS_IN_SYNC) {
+    DictionaryTrie dict;
+    dict.insert("apple", 5);
+    dict.insert("ape", 3);
+    ASSERT_EQ(dict.frequency("apple"), 5);
+    ASSERT_EQ(dict.frequency("ap"), 0);
+    dict.buildIndex();
+    ASSERT_EQ(dict.find("apple"), true);
+    ASSERT_EQ(dict.find("ap"), false);
+    ASSERT_EQ(dict.insert("ape", 9), false);
+    ASSERT_EQ(dict.insert("app", 2), true);
+    ASSERT_EQ(dict.find("app"), true);
+    ASSERT_EQ(dict.frequency("ape"), 3);
+    ASSERT_EQ(dict.frequency("app"), 2);
+    ASSERT_EQ(dict.frequency("apps"), 0);
+    ASSERT_EQ(dict.predictCompletions("ap", 3),
+              vector<string>({"app", "ape", "apple"}));
+    ASSERT_GT(dict.stats().indexBytes, 0);
+
+    DictionaryTrie empty;
+    empty.buildIndex();
+    ASSERT_EQ(empty.insert("joey", 1), true);
+    ASSERT_EQ(empty.find("joey"), true);
+    ASSERT_EQ(empty.frequency("joey"), 1);
+}
+
 /*  PREDICT COMPLETIONS TESTS   */
 TEST(DictTrieTests, PREDICT_EMPTY) {
     DictionaryTrie dict;
@@ -151,3 +201,406 @@ TEST(DictTrieTests, COMPLETE_ALL_UNDERSCORES) {
     vector<string> vec = dict.predictUnderscores("___", 1);
     ASSERT_EQ(compare, vec);
 }
+
+/*  STATS TESTS   */
+
+TEST(DictTrieTests, STATS_EMPTY) {
+    DictionaryTrie dict;
+    TrieStats stats = dict.stats();
+    ASSERT_EQ(stats.nodeCount, 0);
+    ASSERT_EQ(stats.wordCount, 0);
+    ASSERT_EQ(stats.nodeBytes, 0);
+    ASSERT_EQ(stats.averageSearchDepth(), 0.0);
+}
+TEST(DictTrieTests, STATS_COUNTS_AND_BYTES) {
+    DictionaryTrie dict;
+    dict.insert("ape", 3);
+    dict.insert("apple", 5);
+    dict.insert("bat", 2);
+    TrieStats stats = dict.stats();
+    // a-p-e, p-l-e under the shared "ap", b-a-t to the right of 'a'
+    ASSERT_EQ(stats.nodeCount, 9);
+    ASSERT_EQ(stats.wordCount, 3);
+    ASSERT_EQ(stats.nodeBytes, stats.pointerBytes + stats.labelBytes +
+                                   stats.frequencyBytes + stats.countBytes +
+                                   stats.paddingBytes);
+    ASSERT_EQ(stats.totalBytes(), stats.objectBytes + stats.nodeBytes);
+}
+TEST(DictTrieTests, STATS_SHAPE) {
+    DictionaryTrie dict;
+    dict.insert("ape", 3);
+    dict.insert("apple", 5);
+    dict.insert("bat", 2);
+    TrieStats stats = dict.stats();
+    // ape: 3, apple: a-p-e-p-l-e = 6, bat: a-b-a-t = 4
+    ASSERT_EQ(stats.totalSearchDepth, 13);
+    ASSERT_EQ(stats.maxSearchDepth, 6);
+    ASSERT_EQ(stats.levels.size(), 5);
+    ASSERT_EQ(stats.levels[0].nodes, 2);
+    ASSERT_EQ(stats.levels[0].rightLinks, 1);
+    ASSERT_EQ(stats.levels[0].maxImbalance, 1);
+    ASSERT_EQ(stats.levels[2].nodes, 3);
+    // 'p' under "a" has the two letters 'e' and 'l' below it
+    ASSERT_EQ(stats.fanOut[2], 1);
+    ASSERT_EQ(stats.fanOut[0], 3);
+}
+
+/*  PARALLEL LOAD TESTS   */
+
+/* dictionary file contents with several first letters and a duplicate */
+static const string DICT_FILE =
+    "5 apple\n4 appendage\n3 ape\n69 tired\n420 sad\n9000 deez\n"
+    "5000 nuts\n2 apparent\n7 the  big   apple\n8 sad\n1 zebra\n6 bij\n";
+
+TEST(DictTrieTests, PARALLEL_LOAD_MATCHES_SEQUENTIAL) {
+    for (unsigned int threads = 1; threads <= 5; threads++) {
+        DictionaryTrie sequential;
+        DictionaryTrie parallel;
+        istringstream sequentialIn(DICT_FILE);
+        istringstream parallelIn(DICT_FILE);
+        Utils::loadDict(sequential, sequentialIn);
+        Utils::loadDictParallel(parallel, parallelIn, threads);
+
+        // same words, same nodes, same shape
+        TrieStats expected = sequential.stats();
+        TrieStats actual = parallel.stats();
+        ASSERT_EQ(actual.nodeCount, expected.nodeCount);
+        ASSERT_EQ(actual.wordCount, 11);
+        ASSERT_EQ(actual.totalSearchDepth, expected.totalSearchDepth);
+
+        ASSERT_EQ(parallel.find("the big apple"), true);
+        ASSERT_EQ(parallel.predictCompletions("a", 3),
+                  sequential.predictCompletions("a", 3));
+        ASSERT_EQ(parallel.predictCompletions("s", 3),
+                  vector<string>({"sad"}));
+        ASSERT_EQ(parallel.predictUnderscores("___", 3),
+                  sequential.predictUnderscores("___", 3));
+    }
+}
+TEST(DictTrieTests, PARALLEL_LOAD_INTO_NONEMPTY) {
+    DictionaryTrie dict;
+    dict.insert("apple", 1);
+    istringstream in(DICT_FILE);
+    Utils::loadDictParallel(dict, in, 3);
+    ASSERT_EQ(dict.stats().wordCount, 11);
+    ASSERT_EQ(dict.predictCompletions("app", 1), vector<string>({"appendage"}));
+}
+TEST(DictTrieTests, PARALLEL_LOAD_KEEPS_INDEX) {
+    DictionaryTrie dict;
+    dict.buildIndex();
+    istringstream in(DICT_FILE);
+    Utils::loadDictParallel(dict, in, 3);
+    ASSERT_EQ(dict.find("the big apple"), true);
+    ASSERT_EQ(dict.frequency("sad"), 420);  // the first of the duplicates
+    ASSERT_EQ(dict.frequency("zebra"), 1);
+    ASSERT_EQ(dict.find("zeb"), false);
+}
+
+/*  FREQUENCY LEARNING TESTS   */
+
+TEST(DictTrieTests, RECORD_SELECTION) {
+    DictionaryTrie dict;
+    dict.insert("apple", 5);
+    dict.insert("ape", 3);
+    dict.insert("app", 2);
+    ASSERT_EQ(dict.recordSelection("ap"), false);
+    ASSERT_EQ(dict.recordSelection("apples"), false);
+    ASSERT_EQ(dict.recordSelection("app", 10), true);
+    ASSERT_EQ(dict.recordSelection("app"), true);
+    ASSERT_EQ(dict.frequency("app"), 13);
+    ASSERT_EQ(dict.predictCompletions("ap", 1), vector<string>({"app"}));
+    ASSERT_EQ(dict.repairFrequencies(), 2);
+    ASSERT_EQ(dict.repairFrequencies(), 0);
+}
+TEST(DictTrieTests, RECORD_SELECTION_CONCURRENT) {
+    DictionaryTrie dict;
+    dict.insert("apple", 5);
+    dict.insert("ape", 3);
+    dict.buildIndex();
+    vector<thread> threads;
+    for (unsigned int t = 0; t < 4; t++) {
+        threads.push_back(thread([&dict]() {
+            for (unsigned int i = 0; i < 10000; i++) {
+                dict.recordSelection(i % 2 ? "apple" : "ape");
+            }
+        }));
+    }
+    for (unsigned int t = 0; t < threads.size(); t++) {
+        threads[t].join();
+    }
+    ASSERT_EQ(dict.frequency("apple"), 20005);
+    ASSERT_EQ(dict.frequency("ape"), 20003);
+    ASSERT_EQ(dict.repairFrequencies(), 40000);
+}
+TEST(DictTrieTests, DECAY) {
+    DictionaryTrie dict;
+    dict.insert("apple", 100);
+    dict.insert("ape", 41);
+    dict.insert("a", 1);
+    dict.buildIndex();
+    dict.repairFrequencies(0.5);
+    ASSERT_EQ(dict.frequency("apple"), 50);
+    ASSERT_EQ(dict.frequency("ape"), 20);  // rounded down
+    ASSERT_EQ(dict.frequency("a"), 1);     // never decays away
+    dict.recordSelection("ape", 32);
+    dict.repairFrequencies(0.5);
+    ASSERT_EQ(dict.frequency("apple"), 25);
+    ASSERT_EQ(dict.frequency("ape"), 26);
+    ASSERT_EQ(dict.predictCompletions("ap", 2),
+              vector<string>({"apple", "ape"}));
+}
+TEST(DictTrieTests, DECAY_SMALL_FREQUENCIES) {
+    DictionaryTrie dict;
+    dict.insert("apple", 4);
+    dict.insert("ape", 3);
+    dict.buildIndex();
+    // 0.9 is the mildest decay FrequencyLearner uses
+    vector<unsigned int> expected = {3, 2, 1, 1};
+    for (unsigned int i = 0; i < expected.size(); i++) {
+        dict.repairFrequencies(0.9);
+        ASSERT_EQ(dict.frequency("apple"), expected[i]);
+    }
+    dict.recordSelection("ape", 7);  // 1 + 7, seen by the index too
+    dict.repairFrequencies(0.9);
+    ASSERT_EQ(dict.frequency("ape"), 7);
+    dict.repairFrequencies(1.0);
+    ASSERT_EQ(dict.frequency("ape"), 7);
+    ASSERT_EQ(dict.predictCompletions("ap", 1), vector<string>({"ape"}));
+}
+
+/*  PREFIX COUNT AND PAGING TESTS   */
+
+/* every <frequency, word> pair of dict starting with prefix, best first */
+static vector<pair<unsigned int, string>> bruteForceCompletions(
+    const DictionaryTrie& dict, const string& prefix) {
+    vector<pair<unsigned int, string>> words;
+    vector<pair<unsigned int, string>> matches;
+    dict.collectWords(words);
+    for (unsigned int i = 0; i < words.size(); i++) {
+        if (words[i].second.compare(0, prefix.length(), prefix) == 0) {
+            matches.push_back(words[i]);
+        }
+    }
+    sort(matches.begin(), matches.end(),
+         [](const pair<unsigned int, string>& a,
+            const pair<unsigned int, string>& b) {
+             return a.first != b.first ? a.first > b.first
+                                       : a.second < b.second;
+         });
+    return matches;
+}
+
+static const vector<string> PREFIXES = {"",   "a",    "ap", "app", "apple",
+                                        "s",  "sad",  "t",  "the", "zebra",
+                                        "zz", "nuts", "b",  "q"};
+
+TEST(DictTrieTests, COUNT_PREFIX) {
+    DictionaryTrie sequential;
+    DictionaryTrie parallel;
+    istringstream sequentialIn(DICT_FILE);
+    istringstream parallelIn(DICT_FILE);
+    Utils::loadDict(sequential, sequentialIn);
+    Utils::loadDictParallel(parallel, parallelIn, 3);
+    ASSERT_EQ(sequential.countPrefix(""), 11);
+    ASSERT_EQ(sequential.countPrefix("app"), 3);
+    for (unsigned int i = 0; i < PREFIXES.size(); i++) {
+        unsigned int expected =
+            bruteForceCompletions(sequential, PREFIXES[i]).size();
+        ASSERT_EQ(sequential.countPrefix(PREFIXES[i]), expected);
+        ASSERT_EQ(parallel.countPrefix(PREFIXES[i]), expected);
+    }
+    DictionaryTrie empty;
+    ASSERT_EQ(empty.countPrefix(""), 0);
+    ASSERT_EQ(empty.countPrefix("a"), 0);
+}
+TEST(DictTrieTests, COMPLETION_PAGES) {
+    DictionaryTrie dict;
+    istringstream in(DICT_FILE);
+    Utils::loadDict(dict, in);
+    dict.insert("apply", 5);  // ties with apple
+    dict.insert("ax", 5);
+    for (unsigned int pageSize = 1; pageSize <= 4; pageSize++) {
+        for (unsigned int i = 0; i < PREFIXES.size(); i++) {
+            DictionaryTrie::CompletionIterator pages =
+                dict.completions(PREFIXES[i]);
+            vector<pair<unsigned int, string>> listed;
+            vector<pair<unsigned int, string>> page;
+            while (!(page = pages.nextPage(pageSize)).empty()) {
+                ASSERT_LE(page.size(), pageSize);
+                listed.insert(listed.end(), page.begin(), page.end());
+            }
+            ASSERT_EQ(listed, bruteForceCompletions(dict, PREFIXES[i]));
+            ASSERT_EQ(pages.hasNext(), false);
+            ASSERT_EQ(pages.next(), "");
+        }
+    }
+
+    DictionaryTrie::CompletionIterator words = dict.completions("ap");
+    ASSERT_EQ(words.next(), "apple");
+    ASSERT_EQ(words.next(), "apply");
+    ASSERT_EQ(words.hasNext(), true);
+    ASSERT_EQ(words.next(), "appendage");
+    vector<string> best = dict.predictCompletions("t", 2);
+    reverse(best.begin(), best.end());
+    DictionaryTrie::CompletionIterator t = dict.completions("t");
+    ASSERT_EQ(best.size(), 2);
+    ASSERT_EQ(best, vector<string>({t.next(), t.next()}));
+}
+
+/*  INFIX TESTS   */
+
+TEST(DictTrieTests, PREDICT_INFIX) {
+    DictionaryTrie scanned;
+    DictionaryTrie indexed;
+    istringstream scannedIn(DICT_FILE);
+    istringstream indexedIn(DICT_FILE);
+    Utils::loadDict(scanned, scannedIn);
+    indexed.buildInfixIndex();
+    Utils::loadDictParallel(indexed, indexedIn, 3);
+    ASSERT_EQ(indexed.stats().infixBytes > 0, true);
+    ASSERT_EQ(indexed.predictInfix("pp", 3),
+              vector<string>({"appendage", "apple", "the big apple"}));
+
+    // inserted after the index was built
+    scanned.insert("pineapple", 8);
+    indexed.insert("pineapple", 8);
+    vector<string> fragments = {"a",  "pp",  "apple", "e",
+                                "ij", "big", "",      "zz"};
+    for (unsigned int k = 0; k <= 5; k++) {
+        for (unsigned int i = 0; i < fragments.size(); i++) {
+            ASSERT_EQ(indexed.predictInfix(fragments[i], k),
+                      scanned.predictInfix(fragments[i], k));
+        }
+    }
+    ASSERT_EQ(indexed.predictInfix("apple", 2),
+              vector<string>({"the big apple", "pineapple"}));
+}
+TEST(DictTrieTests, PREDICT_INFIX_LEARNED) {
+    DictionaryTrie scanned;
+    DictionaryTrie indexed;
+    istringstream scannedIn(DICT_FILE);
+    istringstream indexedIn(DICT_FILE);
+    Utils::loadDict(scanned, scannedIn);
+    Utils::loadDict(indexed, indexedIn);
+    indexed.buildInfixIndex();
+    scanned.insert("pineapple", 8);  // not in the suffix array yet
+    indexed.insert("pineapple", 8);
+
+    vector<string> fragments = {"a", "pp", "apple", "e", "i"};
+    for (unsigned int pass = 0; pass < 3; pass++) {
+        DictionaryTrie* dicts[] = {&scanned, &indexed};
+        for (DictionaryTrie* dict : dicts) {
+            dict->recordSelection("ape", 10);
+            dict->recordSelection("zebra", 5);
+            dict->repairFrequencies(pass == 0 ? 1.0 : 0.5);
+        }
+        for (unsigned int i = 0; i < fragments.size(); i++) {
+            ASSERT_EQ(indexed.predictInfix(fragments[i], 3),
+                      scanned.predictInfix(fragments[i], 3));
+        }
+    }
+    ASSERT_EQ(indexed.predictInfix("ap", 1), vector<string>({"ape"}));
+}
+
+/*  QUERY BUDGET TESTS   */
+
+TEST(DictTrieTests, BUDGET_UNLIMITED) {
+    DictionaryTrie dict;
+    fillGenerated(dict);
+    vector<string> prefixes = {"a", "ab", "eee", "zz"};
+    for (unsigned int i = 0; i < prefixes.size(); i++) {
+        QueryBudget budget;
+        ASSERT_EQ(dict.predictCompletions(prefixes[i], 10, budget),
+                  dict.predictCompletions(prefixes[i], 10));
+        ASSERT_EQ(budget.exhausted, false);
+    }
+    QueryBudget budget(1000000, chrono::seconds(60));
+    ASSERT_EQ(dict.predictUnderscores("_____", 10, budget),
+              dict.predictUnderscores("_____", 10));
+    ASSERT_EQ(budget.exhausted, false);
+    ASSERT_GT(budget.visits, 100);
+}
+TEST(DictTrieTests, BUDGET_PARTIAL_RESULTS) {
+    DictionaryTrie dict;
+    fillGenerated(dict);
+    vector<string> full = dict.predictCompletions("a", 10);
+    for (unsigned int maxVisits = 1; maxVisits < 60; maxVisits++) {
+        QueryBudget budget(maxVisits);
+        vector<string> partial = dict.predictCompletions("a", 10, budget);
+        ASSERT_LE(budget.visits, maxVisits + 1);
+        // fewer words, but the best ones
+        ASSERT_EQ(partial,
+                  vector<string>(full.end() - partial.size(), full.end()));
+        if (partial.size() < full.size()) {
+            ASSERT_EQ(budget.exhausted, true);
+        }
+    }
+
+    QueryBudget budget(50);
+    vector<string> partial = dict.predictUnderscores("a___", 10, budget);
+    ASSERT_EQ(budget.exhausted, true);
+    for (unsigned int i = 0; i < partial.size(); i++) {
+        ASSERT_EQ(partial[i].length(), 4);
+        ASSERT_EQ(partial[i][0], 'a');
+    }
+}
+TEST(DictTrieTests, BUDGET_DEADLINE) {
+    DictionaryTrie dict;
+    fillGenerated(dict);
+    QueryBudget budget(0, chrono::nanoseconds(1));
+    this_thread::sleep_for(chrono::milliseconds(1));
+    dict.predictUnderscores("______", 10, budget);
+    ASSERT_EQ(budget.exhausted, true);
+    ASSERT_EQ(budget.visits, 64);  // the clock is read every 64 visits
+}
+
+/*  MULTI PATTERN TESTS   */
+
+TEST(DictTrieTests, UNDERSCORES_MANY_MATCHES_ONE_BY_ONE) {
+    DictionaryTrie dict;
+    fillGenerated(dict);
+    istringstream in(DICT_FILE);
+    Utils::loadDict(dict, in);
+    // shared starts, duplicates, plain words, no match and empty
+    vector<string> patterns = {"___",    "a__",   "a_c",  "a_c__", "___",
+                               "_b_d",   "e____", "ab",   "abcde", "ap_le",
+                               "______", "z_",    "",     "_",     "t__ ___",
+                               "s_d",    "b_j",   "__e_"};
+    for (unsigned int k = 0; k <= 12; k += 3) {
+        vector<vector<string>> answers =
+            dict.predictUnderscoresMany(patterns, k);
+        ASSERT_EQ(answers.size(), patterns.size());
+        for (unsigned int i = 0; i < patterns.size(); i++) {
+            ASSERT_EQ(answers[i], dict.predictUnderscores(patterns[i], k));
+        }
+    }
+    ASSERT_EQ(DictionaryTrie().predictUnderscoresMany(patterns, 3),
+              vector<vector<string>>(patterns.size()));
+    ASSERT_EQ(dict.predictUnderscoresMany(vector<string>(), 3).size(), 0);
+}
+
+/*  BENCHMARK UTILITY TESTS   */
+
+TEST(DictTrieTests, PERF_COUNTERS) {
+    PerfCounters disabled(false);
+    ASSERT_EQ(disabled.available(), false);
+    disabled.begin();
+    disabled.end();
+    ASSERT_EQ(disabled.count(PerfCounters::INSTRUCTIONS), 0);
+    ostringstream report;
+    disabled.report(report, 10);
+    ASSERT_EQ(report.str(), "");
+
+    // machines without a PMU (most VMs) count nothing at all
+    DictionaryTrie dict;
+    istringstream in(DICT_FILE);
+    Utils::loadDict(dict, in);
+    PerfCounters counters;
+    Timer timer(&counters);
+    timer.begin_timer();
+    ASSERT_EQ(dict.predictCompletions("a", 1), vector<string>({"apple"}));
+    timer.end_timer();
+    if (counters.counting(PerfCounters::INSTRUCTIONS)) {
+        ASSERT_GT(counters.count(PerfCounters::INSTRUCTIONS), 0);
+    }
+}
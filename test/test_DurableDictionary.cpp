@@ -0,0 +1,237 @@
+/**
+ * This File contains several tests
+ * that check the functionality of the
+ * DurableDictionary
+ */
+
+#include <signal.h>
+#include <stdlib.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <chrono>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "DurableDictionary.hpp"
+
+using namespace std;
+using namespace testing;
+
+/* dictionary file the first open is seeded from */
+static const string SEED = "5 apple\n4 appendage\n3 ape\n69 tired\n420 sad\n";
+
+/* a fresh empty directory */
+static string temporaryDirectory() {
+    char path[] = "/tmp/durable_dictionary_XXXXXX";
+    return mkdtemp(path);
+}
+
+/* removes the files a DurableDictionary leaves and the directory */
+static void removeDirectory(const string& directory) {
+    unlink((directory + "/checkpoint").c_str());
+    unlink((directory + "/wal").c_str());
+    rmdir(directory.c_str());
+}
+
+/* syncs never happen on their own in these tests */
+static const chrono::milliseconds NEVER(3600 * 1000);
+
+TEST(DurableDictTests, SEED_AND_REOPEN) {
+    string directory = temporaryDirectory();
+    {
+        DurableDictionary dict(NEVER);
+        istringstream seed(SEED);
+        ASSERT_EQ(dict.open(directory, &seed), true);
+        ASSERT_EQ(dict.find("apple"), true);
+        ASSERT_EQ(dict.insert("app", 2), true);
+        ASSERT_EQ(dict.insert("apple", 9), false);
+        ASSERT_EQ(dict.recordSelection("ape", 10), true);
+        ASSERT_EQ(dict.recordSelection("zebra"), false);
+    }  // the destructor syncs
+    {
+        DurableDictionary dict(NEVER);
+        ASSERT_EQ(dict.open(directory), true);
+        ASSERT_EQ(dict.replayedRecords(), 2);
+        ASSERT_EQ(dict.frequency("app"), 2);
+        ASSERT_EQ(dict.frequency("ape"), 13);
+        ASSERT_EQ(dict.frequency("sad"), 420);
+        ASSERT_EQ(dict.predictCompletions("ap", 2),
+                  vector<string>({"apple", "ape"}));
+    }
+    removeDirectory(directory);
+}
+TEST(DurableDictTests, CHECKPOINT_DROPS_LOG) {
+    string directory = temporaryDirectory();
+    {
+        DurableDictionary dict(NEVER);
+        istringstream seed(SEED);
+        ASSERT_EQ(dict.open(directory, &seed), true);
+        dict.insert("app", 2);
+        dict.recordSelection("app", 5);
+        ASSERT_EQ(dict.checkpoint(), true);
+        dict.insert("apt", 1);
+        ASSERT_EQ(dict.sync(), true);
+    }
+    {
+        DurableDictionary dict(NEVER);
+        ASSERT_EQ(dict.open(directory), true);
+        ASSERT_EQ(dict.replayedRecords(), 1);  // only the insert of apt
+        ASSERT_EQ(dict.frequency("app"), 7);
+        ASSERT_EQ(dict.find("apt"), true);
+    }
+    removeDirectory(directory);
+}
+TEST(DurableDictTests, CHECKPOINTED_WORDS_UNCHANGED) {
+    string directory = temporaryDirectory();
+    vector<string> altered = {"new  york", " lead", "lead ", "a . b",
+                              "tab\there", "line\nbreak"};
+    {
+        DurableDictionary dict(NEVER);
+        ASSERT_EQ(dict.open(directory), true);
+        for (unsigned int i = 0; i < altered.size(); i++) {
+            ASSERT_EQ(dict.insert(altered[i], 3), false);
+        }
+        ASSERT_EQ(dict.insert("new york", 3), true);
+        ASSERT_EQ(dict.insert("a.b", 2), true);
+        ASSERT_EQ(dict.checkpoint(), true);
+    }
+    {
+        DurableDictionary dict(NEVER);
+        ASSERT_EQ(dict.open(directory), true);
+        ASSERT_EQ(dict.frequency("new york"), 3);
+        ASSERT_EQ(dict.frequency("a.b"), 2);
+        ASSERT_EQ(dict.find("new"), false);
+        ASSERT_EQ(dict.find("a"), false);
+    }
+    removeDirectory(directory);
+}
+TEST(DurableDictTests, DECAY_REPLAYED) {
+    string directory = temporaryDirectory();
+    {
+        DurableDictionary dict(NEVER);
+        istringstream seed(SEED);
+        ASSERT_EQ(dict.open(directory, &seed), true);
+        dict.recordSelection("ape", 7);
+        dict.repairFrequencies(0.5);
+        dict.recordSelection("ape", 1);
+    }
+    {
+        DurableDictionary dict(NEVER);
+        ASSERT_EQ(dict.open(directory), true);
+        ASSERT_EQ(dict.replayedRecords(), 3);
+        ASSERT_EQ(dict.frequency("ape"), 6);
+        ASSERT_EQ(dict.frequency("sad"), 210);
+    }
+    removeDirectory(directory);
+}
+TEST(DurableDictTests, TORN_TAIL) {
+    string directory = temporaryDirectory();
+    {
+        DurableDictionary dict(NEVER);
+        istringstream seed(SEED);
+        ASSERT_EQ(dict.open(directory, &seed), true);
+        dict.insert("app", 2);
+    }
+    {
+        // a crash in the middle of writing a record
+        ofstream wal(directory + "/wal", ios::app);
+        wal << "2 I 7 zeb";
+    }
+    {
+        DurableDictionary dict(NEVER);
+        ASSERT_EQ(dict.open(directory), true);
+        ASSERT_EQ(dict.replayedRecords(), 1);
+        ASSERT_EQ(dict.find("zeb"), false);
+        ASSERT_EQ(dict.insert("zebra", 1), true);
+    }
+    {
+        DurableDictionary dict(NEVER);
+        ASSERT_EQ(dict.open(directory), true);
+        ASSERT_EQ(dict.replayedRecords(), 2);
+        ASSERT_EQ(dict.find("zebra"), true);
+    }
+    removeDirectory(directory);
+}
+TEST(DurableDictTests, BAD_CHECKPOINT) {
+    string directory = temporaryDirectory();
+    {
+        ofstream checkpoint(directory + "/checkpoint");
+        checkpoint << "5 apple\n";
+    }
+    DurableDictionary dict(NEVER);
+    ASSERT_EQ(dict.open(directory), false);
+    {
+        ofstream checkpoint(directory + "/checkpoint");
+        checkpoint << "#checkpoint 99999999999999999999\n5 apple\n";
+    }
+    ASSERT_EQ(dict.open(directory), false);
+    removeDirectory(directory);
+}
+TEST(DurableDictTests, BAD_RECORD) {
+    string directory = temporaryDirectory();
+    {
+        ofstream checkpoint(directory + "/checkpoint");
+        checkpoint << "#checkpoint 0\n5 apple\n";
+        ofstream wal(directory + "/wal");
+        wal << "1 I 7 zeb\n2 I x zebra\n3 I 2 bee\n";
+    }
+    {
+        // the bad record ends the log like a torn tail
+        DurableDictionary dict(NEVER);
+        ASSERT_EQ(dict.open(directory), true);
+        ASSERT_EQ(dict.replayedRecords(), 1);
+        ASSERT_EQ(dict.find("zeb"), true);
+        ASSERT_EQ(dict.find("bee"), false);
+        ASSERT_EQ(dict.insert("bee", 2), true);
+    }
+    {
+        DurableDictionary dict(NEVER);
+        ASSERT_EQ(dict.open(directory), true);
+        ASSERT_EQ(dict.replayedRecords(), 2);
+        ASSERT_EQ(dict.frequency("bee"), 2);
+    }
+    removeDirectory(directory);
+}
+TEST(DurableDictTests, WRITE_FAILURE) {
+    string directory = temporaryDirectory();
+    {
+        DurableDictionary dict(NEVER);
+        istringstream seed(SEED);
+        ASSERT_EQ(dict.open(directory, &seed), true);
+        dict.insert("app", 2);
+        ASSERT_EQ(dict.sync(), true);
+
+        // let the next write stop a few bytes into the record
+        struct stat log;
+        stat((directory + "/wal").c_str(), &log);
+        struct rlimit limit;
+        getrlimit(RLIMIT_FSIZE, &limit);
+        struct rlimit small = limit;
+        small.rlim_cur = log.st_size + 4;
+        signal(SIGXFSZ, SIG_IGN);
+        setrlimit(RLIMIT_FSIZE, &small);
+        dict.insert("appendix", 3);
+        bool synced = dict.sync();
+        setrlimit(RLIMIT_FSIZE, &limit);
+        signal(SIGXFSZ, SIG_DFL);
+
+        ASSERT_EQ(synced, false);
+        ASSERT_EQ(dict.logFailed(), true);
+        ASSERT_EQ(dict.insert("bee", 1), false);
+        stat((directory + "/wal").c_str(), &log);
+        ASSERT_EQ(log.st_size, small.rlim_cur - 4);
+    }  // the destructor writes the kept batch
+    {
+        DurableDictionary dict(NEVER);
+        ASSERT_EQ(dict.open(directory), true);
+        ASSERT_EQ(dict.replayedRecords(), 2);
+        ASSERT_EQ(dict.frequency("appendix"), 3);
+        ASSERT_EQ(dict.find("bee"), false);
+        ASSERT_EQ(dict.logFailed(), false);
+    }
+    removeDirectory(directory);
+}
@@ -0,0 +1,53 @@
+/**
+ * This File contains several tests
+ * that check the functionality of the
+ * FrequencyLearner
+ */
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "DictionaryTrie.hpp"
+#include "FrequencyLearner.hpp"
+
+using namespace std;
+using namespace testing;
+
+/* waits until the learner has run at least one more pass, for up to 5
+ * seconds. The pass may have started before the call
+ */
+static void waitForPass(FrequencyLearner& learner) {
+    unsigned long long before = learner.passes();
+    for (unsigned int i = 0; i < 1000 && learner.passes() <= before; i++) {
+        this_thread::sleep_for(chrono::milliseconds(5));
+    }
+    ASSERT_GT(learner.passes(), before);
+}
+
+TEST(FrequencyLearnerTests, REPAIRS_IN_BACKGROUND) {
+    DictionaryTrie dict;
+    dict.insert("apple", 5);
+    dict.insert("ape", 3);
+    FrequencyLearner learner(dict, chrono::milliseconds(5));
+    dict.recordSelection("ape", 10);
+    // the first pass may have been repairing before the selection
+    ASSERT_NO_FATAL_FAILURE(waitForPass(learner));
+    ASSERT_NO_FATAL_FAILURE(waitForPass(learner));
+    ASSERT_EQ(dict.repairFrequencies(), 0);  // already folded in
+    ASSERT_EQ(dict.frequency("ape"), 13);
+    ASSERT_EQ(dict.predictCompletions("ap", 1), vector<string>({"ape"}));
+}
+TEST(FrequencyLearnerTests, DECAYS) {
+    DictionaryTrie dict;
+    dict.insert("apple", 1000000);
+    {
+        FrequencyLearner learner(dict, chrono::milliseconds(5),
+                                 chrono::milliseconds(20));
+        this_thread::sleep_for(chrono::milliseconds(200));
+    }
+    ASSERT_LT(dict.frequency("apple"), 500000);
+    ASSERT_GE(dict.frequency("apple"), 1);
+}
@@ -0,0 +1,118 @@
+/**
+ * This File contains several tests
+ * that check the functionality of the
+ * InfixIndex
+ */
+
+#include <algorithm>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "InfixIndex.hpp"
+
+using namespace std;
+using namespace testing;
+
+static const vector<pair<unsigned int, string>> WORDS = {
+    {5, "apple"},         {4, "pineapple"}, {9, "new york city"},
+    {3, "york"},          {9, "new york"},  {2, "yorkshire pudding"},
+    {7, "banana"},        {1, "nana"},      {6, "the big apple"},
+    {4, "grapple"}};
+
+/* the words of index containing fragment, best first, by scanning */
+static vector<string> scan(const InfixIndex& index, const string& fragment,
+                           bool tokenStartsOnly) {
+    vector<pair<unsigned int, string>> matches;
+    for (unsigned int id = 0; id < index.size(); id++) {
+        string word = index.word(id);
+        for (size_t at = word.find(fragment); at != string::npos;
+             at = word.find(fragment, at + 1)) {
+            if (!tokenStartsOnly ||
+                (word[at] != ' ' && (at == 0 || word[at - 1] == ' '))) {
+                matches.push_back({index.frequency(id), word});
+                break;
+            }
+        }
+    }
+    sort(matches.begin(), matches.end(),
+         [](const pair<unsigned int, string>& a,
+            const pair<unsigned int, string>& b) {
+             return a.first != b.first ? a.first > b.first
+                                       : a.second < b.second;
+         });
+    vector<string> words;
+    for (unsigned int i = 0; i < matches.size(); i++) {
+        words.push_back(matches[i].second);
+    }
+    return words;
+}
+
+/* the words with the ids index.search returns */
+static vector<string> search(const InfixIndex& index, const string& fragment,
+                             unsigned int k) {
+    vector<unsigned int> ids = index.search(fragment, k);
+    vector<string> words;
+    for (unsigned int i = 0; i < ids.size(); i++) {
+        words.push_back(index.word(ids[i]));
+    }
+    return words;
+}
+
+TEST(InfixIndexTests, SEARCH) {
+    InfixIndex index(WORDS);
+    ASSERT_EQ(index.size(), 10);
+    ASSERT_EQ(search(index, "york", 3),
+              vector<string>({"new york", "new york city", "york"}));
+    ASSERT_EQ(search(index, "apple", 10),
+              vector<string>({"the big apple", "apple", "grapple",
+                              "pineapple"}));
+    // banana holds "ana" twice, it comes out once
+    ASSERT_EQ(search(index, "ana", 10), vector<string>({"banana", "nana"}));
+    ASSERT_EQ(search(index, "zebra", 10), vector<string>());
+    ASSERT_EQ(search(index, "", 10), vector<string>());
+    ASSERT_EQ(search(index, "a", 0), vector<string>());
+}
+TEST(InfixIndexTests, TOKEN_STARTS_ONLY) {
+    InfixIndex index(WORDS, true);
+    ASSERT_EQ(index.indexesTokenStartsOnly(), true);
+    ASSERT_EQ(search(index, "york", 10),
+              vector<string>({"new york", "new york city", "york",
+                              "yorkshire pudding"}));
+    ASSERT_EQ(search(index, "ork", 10), vector<string>());
+    ASSERT_EQ(search(index, "apple", 10),
+              vector<string>({"the big apple", "apple"}));
+    ASSERT_LT(index.sizeInBytes(), InfixIndex(WORDS).sizeInBytes());
+}
+TEST(InfixIndexTests, INSERT_MATCHES_SCAN) {
+    // enough inserts to go through several rebuilds
+    mt19937 generator(7);
+    uniform_int_distribution<int> letter('a', 'e');
+    uniform_int_distribution<int> length(1, 8);
+    for (unsigned int tokens = 0; tokens <= 1; tokens++) {
+        InfixIndex index(WORDS, tokens);
+        for (unsigned int i = 0; i < 2000; i++) {
+            string word;
+            for (int j = length(generator); j > 0; j--) {
+                word.push_back(j == 4 ? ' ' : letter(generator));
+            }
+            ASSERT_EQ(index.insert(word + to_string(i), i % 50 + 1), true);
+            if (i % 97 == 0) {
+                vector<string> fragments = {"a", "ab", "cde", " b", "e1",
+                                            "apple", "9"};
+                for (unsigned int f = 0; f < fragments.size(); f++) {
+                    vector<string> expected =
+                        scan(index, fragments[f], tokens);
+                    expected.resize(min<size_t>(expected.size(), 15));
+                    ASSERT_EQ(search(index, fragments[f], 15), expected);
+                }
+            }
+        }
+    }
+    InfixIndex index;
+    ASSERT_EQ(index.insert("", 1), false);
+    ASSERT_EQ(index.insert("apple", 0), false);
+    ASSERT_EQ(index.size(), 0);
+}
@@ -0,0 +1,148 @@
+/**
+ * This File contains several tests
+ * that check the functionality of the
+ * LayeredDictionary
+ */
+
+#include <atomic>
+#include <chrono>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "DictionaryTrie.hpp"
+#include "LayeredDictionary.hpp"
+
+using namespace std;
+using namespace testing;
+
+/* base words, distinct frequencies, one duplicate */
+static const vector<pair<unsigned int, string>> BASE = {
+    {5, "apple"}, {4, "appendage"}, {3, "ape"}, {69, "tired"},
+    {420, "sad"}, {900, "bij"},     {8, "sad"}, {50, "aij"}};
+
+/* words inserted later */
+static const vector<pair<unsigned int, string>> NEW_WORDS = {
+    {2, "apparent"}, {800, "boj"}, {700, "baj"}, {60, "tij"},
+    {10, "sij"},     {6, "app"}};
+
+/* a plain trie holding the first of the duplicates of both lists */
+static void fillExpected(DictionaryTrie& dict) {
+    for (unsigned int i = 0; i < BASE.size(); i++) {
+        dict.insert(BASE[i].second, BASE[i].first);
+    }
+    for (unsigned int i = 0; i < NEW_WORDS.size(); i++) {
+        dict.insert(NEW_WORDS[i].second, NEW_WORDS[i].first);
+    }
+}
+
+/* same answers as the plain trie for a few prefixes and patterns */
+static void expectSameAnswers(const LayeredDictionary& layered,
+                              const DictionaryTrie& dict) {
+    vector<string> prefixes = {"a", "ap", "app", "b", "s", "t", "x"};
+    vector<string> patterns = {"___", "a__", "_pp__", "b_j"};
+    for (unsigned int k = 0; k <= 6; k++) {
+        for (unsigned int i = 0; i < prefixes.size(); i++) {
+            ASSERT_EQ(layered.predictCompletions(prefixes[i], k),
+                      dict.predictCompletions(prefixes[i], k));
+        }
+        for (unsigned int i = 0; i < patterns.size(); i++) {
+            ASSERT_EQ(layered.predictUnderscores(patterns[i], k),
+                      dict.predictUnderscores(patterns[i], k));
+        }
+    }
+}
+
+/* INSERT/FIND TESTS */
+TEST(LayeredDictTests, BASE_ONLY) {
+    LayeredDictionary layered(BASE);
+    ASSERT_EQ(layered.size(), 7);
+    ASSERT_EQ(layered.pendingWords(), 0);
+    ASSERT_EQ(layered.find("apple"), true);
+    ASSERT_EQ(layered.find("app"), false);
+    ASSERT_EQ(layered.frequency("sad"), 420);
+    ASSERT_EQ(layered.merge(), false);
+}
+TEST(LayeredDictTests, INSERT_INTO_DELTA) {
+    LayeredDictionary layered(BASE, 1000, chrono::milliseconds(60000));
+    for (unsigned int i = 0; i < NEW_WORDS.size(); i++) {
+        ASSERT_EQ(layered.insert(NEW_WORDS[i].second, NEW_WORDS[i].first),
+                  true);
+    }
+    ASSERT_EQ(layered.insert("apple", 1), false);  // in the base
+    ASSERT_EQ(layered.insert("boj", 1), false);    // in the delta
+    ASSERT_EQ(layered.pendingWords(), 6);
+    ASSERT_EQ(layered.find("app"), true);
+    ASSERT_EQ(layered.frequency("boj"), 800);
+
+    DictionaryTrie dict;
+    fillExpected(dict);
+    expectSameAnswers(layered, dict);
+}
+
+/* MERGE TESTS */
+TEST(LayeredDictTests, MERGE_KEEPS_ANSWERS) {
+    LayeredDictionary layered(BASE, 1000, chrono::milliseconds(60000));
+    for (unsigned int i = 0; i < NEW_WORDS.size(); i++) {
+        layered.insert(NEW_WORDS[i].second, NEW_WORDS[i].first);
+    }
+    ASSERT_EQ(layered.merge(), true);
+    ASSERT_EQ(layered.merges(), 1);
+    ASSERT_EQ(layered.pendingWords(), 0);
+    ASSERT_EQ(layered.size(), 13);
+    ASSERT_EQ(layered.insert("boj", 1), false);  // now in the base
+
+    DictionaryTrie dict;
+    fillExpected(dict);
+    expectSameAnswers(layered, dict);
+}
+TEST(LayeredDictTests, BACKGROUND_MERGE) {
+    LayeredDictionary layered(BASE, 2, chrono::milliseconds(10));
+    layered.insert("apparent", 2);
+    layered.insert("boj", 800);
+    for (unsigned int i = 0; i < 500 && layered.merges() == 0; i++) {
+        this_thread::sleep_for(chrono::milliseconds(10));
+    }
+    ASSERT_GE(layered.merges(), 1);
+    ASSERT_EQ(layered.pendingWords(), 0);
+    ASSERT_EQ(layered.frequency("boj"), 800);
+}
+TEST(LayeredDictTests, FULL_DELTA_DURING_MERGE) {
+    // no interval merges, only inserts filling the delta wake the merger
+    LayeredDictionary layered(BASE, 100, chrono::hours(1));
+    for (unsigned int i = 0; i < 5000; i++) {
+        layered.insert("word" + to_string(i), i + 1);
+    }
+    for (unsigned int i = 0; i < 500 && layered.pendingWords() >= 100; i++) {
+        this_thread::sleep_for(chrono::milliseconds(10));
+    }
+    ASSERT_LT(layered.pendingWords(), 100);
+    ASSERT_EQ(layered.frequency("word4999"), 5000);
+}
+TEST(LayeredDictTests, READERS_DURING_MERGES) {
+    LayeredDictionary layered(BASE, 3, chrono::milliseconds(1));
+    atomic<bool> done(false);
+    atomic<unsigned int> wrong(0);
+    // the base words never change, whatever layer the new ones are in
+    thread reader([&]() {
+        while (!done) {
+            if (layered.predictCompletions("ap", 1) !=
+                    vector<string>({"apple"}) ||
+                !layered.find("tired")) {
+                wrong++;
+            }
+        }
+    });
+    for (unsigned int i = 0; i < 300; i++) {
+        ASSERT_EQ(layered.insert("new" + to_string(i), 1), true);
+    }
+    layered.merge();
+    done = true;
+    reader.join();
+    ASSERT_EQ(wrong, 0);
+    ASSERT_EQ(layered.size(), 307);
+    ASSERT_EQ(layered.pendingWords(), 0);
+    ASSERT_EQ(layered.predictCompletions("new29", 20).size(), 11);
+}
@@ -0,0 +1,129 @@
+/**
+ * This File contains several tests
+ * that check the functionality of the
+ * LazyDictionary
+ */
+
+#include <stdlib.h>
+#include <unistd.h>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "DictionaryTrie.hpp"
+#include "LazyDictionary.hpp"
+#include "util.hpp"
+
+using namespace std;
+using namespace testing;
+
+/* dictionary file with several first letters, spacing and a duplicate */
+static const string DICT_FILE =
+    "5 apple\n4 appendage\n3 ape\n69 tired\n420 sad\n9000 deez\n"
+    "5000 nuts\n2 apparent\n7 the  big   apple\n8 sad\n1 zebra\n6 bij\n"
+    "  11   tip\n12\n30 Zoo\n10 boj";
+
+/* writes contents to a fresh temporary file */
+static string temporaryFile(const string& contents) {
+    char path[] = "/tmp/lazy_dictionary_XXXXXX";
+    int fd = mkstemp(path);
+    close(fd);
+    ofstream out(path, ios::binary);
+    out << contents;
+    return path;
+}
+
+TEST(LazyDictTests, OPEN_FAILS) {
+    LazyDictionary lazy;
+    ASSERT_EQ(lazy.open("/tmp/no/such/dictionary"), false);
+    string empty = temporaryFile("");
+    ASSERT_EQ(lazy.open(empty), false);
+    unlink(empty.c_str());
+}
+TEST(LazyDictTests, BUILDS_ONLY_WHAT_IS_ASKED) {
+    string path = temporaryFile(DICT_FILE);
+    LazyDictionary lazy;
+    ASSERT_EQ(lazy.open(path), true);
+    ASSERT_EQ(lazy.lines(), 16);
+    ASSERT_EQ(lazy.builtLetters(), 0);
+
+    ASSERT_EQ(lazy.predictCompletions("ap", 2),
+              vector<string>({"appendage", "apple"}));
+    ASSERT_EQ(lazy.builtLetters(), 1);
+    ASSERT_EQ(lazy.frequency("apple"), 5);
+    ASSERT_EQ(lazy.find("sad"), true);
+    ASSERT_EQ(lazy.frequency("sad"), 420);  // the first of the duplicates
+    ASSERT_EQ(lazy.builtLetters(), 2);
+    ASSERT_EQ(lazy.find("quack"), false);  // no q words, nothing built
+    ASSERT_EQ(lazy.builtLetters(), 2);
+    ASSERT_EQ(lazy.find(""), false);
+    unlink(path.c_str());
+}
+TEST(LazyDictTests, SAME_ANSWERS_AS_EAGER) {
+    string path = temporaryFile(DICT_FILE);
+    LazyDictionary lazy;
+    ASSERT_EQ(lazy.open(path), true);
+    DictionaryTrie eager;
+    istringstream in(DICT_FILE);
+    Utils::loadDict(eager, in);
+
+    vector<string> words = {"apple", "the big apple", "tip", "Zoo",
+                            "boj",   "bij",           "12",  "zebra"};
+    for (unsigned int i = 0; i < words.size(); i++) {
+        ASSERT_EQ(lazy.frequency(words[i]), eager.frequency(words[i]));
+    }
+    vector<string> prefixes = {"a", "ap", "t", "the ", "b", "Z", "x", ""};
+    vector<string> patterns = {"t_p", "b_j", "___", "_____", "a__"};
+    for (unsigned int k = 0; k <= 4; k++) {
+        for (unsigned int i = 0; i < prefixes.size(); i++) {
+            ASSERT_EQ(lazy.predictCompletions(prefixes[i], k),
+                      eager.predictCompletions(prefixes[i], k));
+        }
+        for (unsigned int i = 0; i < patterns.size(); i++) {
+            // answers across letters only agree up to frequency ties
+            vector<string> lazyAnswer = lazy.predictUnderscores(patterns[i], k);
+            vector<string> eagerAnswer =
+                eager.predictUnderscores(patterns[i], k);
+            ASSERT_EQ(lazyAnswer.size(), eagerAnswer.size());
+            for (unsigned int j = 0; j < lazyAnswer.size(); j++) {
+                ASSERT_EQ(lazy.frequency(lazyAnswer[j]),
+                          eager.frequency(eagerAnswer[j]));
+            }
+        }
+    }
+    unlink(path.c_str());
+}
+TEST(LazyDictTests, CONCURRENT_FIRST_QUERIES) {
+    string contents;
+    for (unsigned int i = 0; i < 5000; i++) {
+        contents += to_string(i + 1) + " " + (char)('a' + i % 26) + "word" +
+                    to_string(i) + "\n";
+    }
+    string path = temporaryFile(contents);
+    LazyDictionary lazy;
+    ASSERT_EQ(lazy.open(path), true);
+
+    // every thread asks about every letter, each is built exactly once
+    vector<thread> threads;
+    vector<unsigned int> found(8, 0);
+    for (unsigned int t = 0; t < found.size(); t++) {
+        threads.push_back(thread([&, t]() {
+            for (unsigned int i = 0; i < 26; i++) {
+                char first = 'a' + (i + t * 3) % 26;
+                found[t] += lazy.predictCompletions(string(1, first), 1000)
+                                .size();
+            }
+        }));
+    }
+    for (unsigned int t = 0; t < threads.size(); t++) {
+        threads[t].join();
+    }
+    for (unsigned int t = 0; t < found.size(); t++) {
+        ASSERT_EQ(found[t], 5000);
+    }
+    ASSERT_EQ(lazy.builtLetters(), 26);
+    unlink(path.c_str());
+}
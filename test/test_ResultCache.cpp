@@ -0,0 +1,109 @@
+/**
+ * This File contains several tests
+ * that check the functionality of the
+ * ResultCache and CachedDictionary
+ */
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "DictionaryTrie.hpp"
+#include "ResultCache.hpp"
+
+using namespace std;
+using namespace testing;
+
+/* GET/PUT TESTS */
+TEST(ResultCacheTests, MISS_THEN_HIT) {
+    ResultCache cache(8);
+    vector<string> results;
+    ASSERT_EQ(cache.get(PREFIX_QUERY, "ap", 2, results), false);
+    cache.put(PREFIX_QUERY, "ap", 2, {"ape", "apple"});
+    ASSERT_EQ(cache.get(PREFIX_QUERY, "ap", 2, results), true);
+    ASSERT_EQ(results, vector<string>({"ape", "apple"}));
+    ASSERT_EQ(cache.hits(), 1);
+    ASSERT_EQ(cache.misses(), 1);
+    ASSERT_EQ(cache.hitRate(), 0.5);
+}
+TEST(ResultCacheTests, KEYED_BY_TYPE_AND_K) {
+    ResultCache cache(8);
+    vector<string> results;
+    cache.put(PREFIX_QUERY, "a_", 2, {"ab"});
+    ASSERT_EQ(cache.get(PATTERN_QUERY, "a_", 2, results), false);
+    ASSERT_EQ(cache.get(PREFIX_QUERY, "a_", 3, results), false);
+    ASSERT_EQ(cache.get(PREFIX_QUERY, "a_", 2, results), true);
+}
+TEST(ResultCacheTests, EVICTS_LEAST_RECENTLY_USED) {
+    ResultCache cache(2, 1);
+    vector<string> results;
+    cache.put(PREFIX_QUERY, "a", 1, {"a"});
+    cache.put(PREFIX_QUERY, "b", 1, {"b"});
+    cache.get(PREFIX_QUERY, "a", 1, results);  // "b" is now the oldest
+    cache.put(PREFIX_QUERY, "c", 1, {"c"});
+    ASSERT_EQ(cache.size(), 2);
+    ASSERT_EQ(cache.get(PREFIX_QUERY, "a", 1, results), true);
+    ASSERT_EQ(cache.get(PREFIX_QUERY, "b", 1, results), false);
+    ASSERT_EQ(cache.get(PREFIX_QUERY, "c", 1, results), true);
+}
+
+/* INVALIDATION TESTS */
+TEST(ResultCacheTests, INVALIDATE_PREFIXES_ONLY) {
+    ResultCache cache(16, 1);
+    vector<string> results;
+    cache.put(PREFIX_QUERY, "a", 1, {"ape"});
+    cache.put(PREFIX_QUERY, "ap", 1, {"ape"});
+    cache.put(PREFIX_QUERY, "ap", 5, {"ape"});
+    cache.put(PREFIX_QUERY, "b", 1, {"bat"});
+    cache.put(PREFIX_QUERY, "apples", 1, {"apples"});
+    cache.invalidate("apple");
+    ASSERT_EQ(cache.get(PREFIX_QUERY, "a", 1, results), false);
+    ASSERT_EQ(cache.get(PREFIX_QUERY, "ap", 1, results), false);
+    ASSERT_EQ(cache.get(PREFIX_QUERY, "ap", 5, results), false);
+    ASSERT_EQ(cache.get(PREFIX_QUERY, "b", 1, results), true);
+    ASSERT_EQ(cache.get(PREFIX_QUERY, "apples", 1, results), true);
+    ASSERT_EQ(cache.invalidations(), 3);
+}
+TEST(ResultCacheTests, INVALIDATE_MATCHING_PATTERNS) {
+    ResultCache cache(16, 1);
+    vector<string> results;
+    cache.put(PATTERN_QUERY, "b_j", 1, {"bij"});
+    cache.put(PATTERN_QUERY, "_o_", 1, {"boj"});
+    cache.put(PATTERN_QUERY, "b__", 1, {"bij"});
+    cache.put(PATTERN_QUERY, "b___", 1, {"bijo"});
+    cache.invalidate("baj");
+    ASSERT_EQ(cache.get(PATTERN_QUERY, "b_j", 1, results), false);
+    ASSERT_EQ(cache.get(PATTERN_QUERY, "b__", 1, results), false);
+    ASSERT_EQ(cache.get(PATTERN_QUERY, "_o_", 1, results), true);
+    ASSERT_EQ(cache.get(PATTERN_QUERY, "b___", 1, results), true);
+}
+
+/* CACHED DICTIONARY TESTS */
+TEST(ResultCacheTests, CACHED_DICTIONARY_SEES_INSERTS) {
+    DictionaryTrie dict;
+    dict.insert("apple", 5);
+    dict.insert("ape", 3);
+    CachedDictionary cached(dict, 16);
+
+    ASSERT_EQ(cached.predictCompletions("ap", 2),
+              dict.predictCompletions("ap", 2));
+    ASSERT_EQ(cached.predictCompletions("ap", 2),
+              vector<string>({"ape", "apple"}));
+    ASSERT_EQ(cached.getCache().hits(), 1);
+
+    ASSERT_EQ(cached.insert("apt", 9), true);
+    ASSERT_EQ(cached.predictCompletions("ap", 2),
+              vector<string>({"apple", "apt"}));
+    ASSERT_EQ(cached.predictUnderscores("a_t", 1), vector<string>({"apt"}));
+    ASSERT_EQ(cached.find("apt"), true);
+}
+TEST(ResultCacheTests, DUPLICATE_INSERT_KEEPS_CACHE) {
+    DictionaryTrie dict;
+    dict.insert("apple", 5);
+    CachedDictionary cached(dict, 16);
+    cached.predictCompletions("a", 1);
+    ASSERT_EQ(cached.insert("apple", 5), false);
+    cached.predictCompletions("a", 1);
+    ASSERT_EQ(cached.getCache().hits(), 1);
+    ASSERT_EQ(cached.getCache().invalidations(), 0);
+}
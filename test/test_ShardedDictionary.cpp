@@ -0,0 +1,80 @@
+/**
+ * This File contains several tests
+ * that check the functionality of the
+ * ShardedDictionary
+ */
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "DictionaryTrie.hpp"
+#include "ShardedDictionary.hpp"
+
+using namespace std;
+using namespace testing;
+
+/* words spread over several leading letters, distinct frequencies */
+static const vector<pair<unsigned int, string>> WORDS = {
+    {5, "apple"}, {4, "appendage"}, {3, "ape"}, {2, "apparent"},
+    {69, "tired"}, {420, "sad"},    {900, "bij"}, {800, "boj"},
+    {700, "baj"}, {60, "tij"},      {10, "sij"},  {50, "aij"}};
+
+/* INSERT/FIND TESTS */
+TEST(ShardedDictTests, EMPTY) {
+    ShardedDictionary dict(4);
+    ASSERT_EQ(dict.find("apple"), false);
+    ASSERT_EQ(dict.predictCompletions("a", 3), vector<string>());
+    ASSERT_EQ(dict.predictUnderscores("_p", 3), vector<string>());
+}
+TEST(ShardedDictTests, INSERT_FIND) {
+    ShardedDictionary dict(4);
+    for (unsigned int i = 0; i < WORDS.size(); i++) {
+        ASSERT_EQ(dict.insert(WORDS[i].second, WORDS[i].first), true);
+    }
+    ASSERT_EQ(dict.insert("apple", 5), false);
+    ASSERT_EQ(dict.find("apple"), true);
+    ASSERT_EQ(dict.find("boj"), true);
+    ASSERT_EQ(dict.find("bo"), false);
+}
+
+/* QUERY TESTS */
+TEST(ShardedDictTests, MATCHES_SINGLE_TRIE) {
+    DictionaryTrie trie;
+    ShardedDictionary dict(3);
+    for (unsigned int i = 0; i < WORDS.size(); i++) {
+        trie.insert(WORDS[i].second, WORDS[i].first);
+        dict.insert(WORDS[i].second, WORDS[i].first);
+    }
+    ASSERT_EQ(dict.predictCompletions("ap", 3),
+              trie.predictCompletions("ap", 3));
+    ASSERT_EQ(dict.predictUnderscores("b_j", 2),
+              trie.predictUnderscores("b_j", 2));
+    ASSERT_EQ(dict.predictUnderscores("_ij", 4),
+              trie.predictUnderscores("_ij", 4));
+}
+TEST(ShardedDictTests, LEADING_UNDERSCORE_MERGES_SHARDS) {
+    ShardedDictionary dict(3);
+    for (unsigned int i = 0; i < WORDS.size(); i++) {
+        dict.insert(WORDS[i].second, WORDS[i].first);
+    }
+    // aij, bij, sij and tij live in different shards
+    ASSERT_EQ(dict.predictUnderscores("_ij", 4),
+              vector<string>({"sij", "aij", "tij", "bij"}));
+    ASSERT_EQ(dict.predictUnderscores("_ij", 2),
+              vector<string>({"tij", "bij"}));
+    ASSERT_EQ(dict.predictUnderscores("___", 3),
+              vector<string>({"baj", "boj", "bij"}));
+}
+TEST(ShardedDictTests, BALANCED_RANGES) {
+    ShardedDictionary dict(2, WORDS);
+    for (unsigned int i = 0; i < WORDS.size(); i++) {
+        dict.insert(WORDS[i].second, WORDS[i].first);
+    }
+    // 8 words start with a or b, 4 with s or t
+    ASSERT_EQ(dict.shard(0).stats().wordCount, 8);
+    ASSERT_EQ(dict.shard(1).stats().wordCount, 4);
+    ASSERT_EQ(dict.predictCompletions("s", 5),
+              vector<string>({"sij", "sad"}));
+}
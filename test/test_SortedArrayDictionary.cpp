@@ -0,0 +1,94 @@
+/**
+ * This File contains several tests
+ * that check the functionality of the
+ * SortedArrayDictionary, and that it answers
+ * like the trie behind the DictionaryEngine interface
+ */
+
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "DictionaryTrie.hpp"
+#include "GeneratedWords.hpp"
+#include "SortedArrayDictionary.hpp"
+#include "util.hpp"
+
+using namespace std;
+using namespace testing;
+
+TEST(SortedArrayTests, INSERT_AND_FIND) {
+    SortedArrayDictionary dict;
+    ASSERT_EQ(dict.insert("apple", 5), true);
+    ASSERT_EQ(dict.insert("ape", 3), true);
+    ASSERT_EQ(dict.insert("apple", 9), false);
+    ASSERT_EQ(dict.insert("", 1), false);
+    ASSERT_EQ(dict.insert("zero", 0), false);
+    ASSERT_EQ(dict.find("apple"), true);
+    ASSERT_EQ(dict.find("app"), false);
+    ASSERT_EQ(dict.frequency("apple"), 5);
+    ASSERT_EQ(dict.size(), 2);
+}
+TEST(SortedArrayTests, PREDICT) {
+    SortedArrayDictionary dict;
+    istringstream in("5 apple\n4 appendage\n3 ape\n69 tired\n420 sad\n");
+    Utils::loadDict(dict, in);
+    ASSERT_EQ(dict.predictCompletions("ap", 2),
+              vector<string>({"appendage", "apple"}));
+    ASSERT_EQ(dict.predictCompletions("app", 10),
+              vector<string>({"appendage", "apple"}));
+    ASSERT_EQ(dict.predictCompletions("", 10), vector<string>());
+    ASSERT_EQ(dict.predictCompletions("b", 10), vector<string>());
+    ASSERT_EQ(dict.predictUnderscores("_a_", 10), vector<string>({"sad"}));
+    ASSERT_EQ(dict.predictUnderscores("ap_le", 10),
+              vector<string>({"apple"}));
+    ASSERT_EQ(dict.predictUnderscores("ap_", 0), vector<string>());
+}
+TEST(SortedArrayTests, SAME_ANSWERS_AS_TRIE) {
+    unique_ptr<DictionaryEngine> trie(Utils::newEngine("trie"));
+    unique_ptr<DictionaryEngine> sorted(Utils::newEngine("sorted"));
+    ASSERT_NE(sorted.get(), nullptr);
+    ASSERT_EQ(Utils::newEngine("hash"), nullptr);
+    fillGenerated(*trie);
+    fillGenerated(*sorted);
+
+    vector<string> prefixes = {"a", "ab", "eee", "cad", "zz"};
+    for (unsigned int i = 0; i < prefixes.size(); i++) {
+        ASSERT_EQ(sorted->predictCompletions(prefixes[i], 10),
+                  trie->predictCompletions(prefixes[i], 10));
+        ASSERT_EQ(sorted->find(prefixes[i]), trie->find(prefixes[i]));
+    }
+    vector<string> patterns = {"___", "a__", "_b_d", "___e_", "e_____"};
+    for (unsigned int i = 0; i < patterns.size(); i++) {
+        ASSERT_EQ(sorted->predictUnderscores(patterns[i], 10),
+                  trie->predictUnderscores(patterns[i], 10));
+    }
+}
+TEST(SortedArrayTests, INSERT_ALL) {
+    // a file's lines, with a duplicate, an empty word and frequency 0
+    vector<pair<unsigned int, string>> words;
+    istringstream in(
+        "5 apple\n4 appendage\n3 ape\n9 apple\n0 zero\n69 tired\n");
+    Utils::loadDict(words, in);
+    words.push_back(pair<unsigned int, string>(2, ""));
+
+    SortedArrayDictionary bulk;
+    bulk.insert("sad", 420);
+    bulk.insert("tired", 1);
+    ASSERT_EQ(bulk.insertAll(words), 3);
+    SortedArrayDictionary oneByOne;
+    oneByOne.insert("sad", 420);
+    oneByOne.insert("tired", 1);
+    ASSERT_EQ(oneByOne.DictionaryEngine::insertAll(words), 3);
+
+    ASSERT_EQ(bulk.size(), 5);
+    ASSERT_EQ(bulk.frequency("apple"), 5);
+    ASSERT_EQ(bulk.frequency("tired"), 1);
+    ASSERT_EQ(bulk.find("zero"), false);
+    ASSERT_EQ(bulk.predictCompletions("a", 10),
+              oneByOne.predictCompletions("a", 10));
+    ASSERT_EQ(bulk.predictUnderscores("___", 10),
+              vector<string>({"ape", "sad"}));
+}
@@ -0,0 +1,93 @@
+/**
+ * This File contains several tests
+ * that check the functionality of the
+ * BitVector, PackedArray and SuccinctTrie
+ */
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "DictionaryTrie.hpp"
+#include "SuccinctTrie.hpp"
+
+using namespace std;
+using namespace testing;
+
+/* BIT VECTOR TESTS */
+TEST(SuccinctTrieTests, RANK_SELECT) {
+    BitVector bits;
+    // 1 at every multiple of 3, long enough to span several blocks
+    for (unsigned int i = 0; i < 2000; i++) {
+        bits.push_back(i % 3 == 0);
+    }
+    bits.build();
+    ASSERT_EQ(bits.rank1(0), 0);
+    ASSERT_EQ(bits.rank1(1), 1);
+    ASSERT_EQ(bits.rank1(1500), 500);
+    ASSERT_EQ(bits.rank0(1500), 1000);
+    ASSERT_EQ(bits.select0(1), 1);
+    ASSERT_EQ(bits.select0(2), 2);
+    ASSERT_EQ(bits.select0(3), 4);
+    ASSERT_EQ(bits.select0(1000), 1499);
+}
+TEST(SuccinctTrieTests, PACKED_ARRAY) {
+    PackedArray values(1000);
+    for (unsigned int i = 0; i < 100; i++) {
+        values.push_back(i * 10);
+    }
+    ASSERT_EQ(values.get(0), 0);
+    ASSERT_EQ(values.get(6), 60);  // spans two words with 10 bit values
+    ASSERT_EQ(values.get(99), 990);
+    ASSERT_EQ(values.sizeInBytes(), 128);
+}
+TEST(SuccinctTrieTests, QUANTIZE_IS_UPPER_BOUND) {
+    for (unsigned int freq = 0; freq < 100000; freq += 7) {
+        ASSERT_GE(SuccinctTrie::dequantize(SuccinctTrie::quantize(freq)),
+                  freq);
+    }
+    ASSERT_GE(SuccinctTrie::dequantize(SuccinctTrie::quantize(4000000000u)),
+              4000000000u);
+}
+
+/* SUCCINCT TRIE TESTS */
+TEST(SuccinctTrieTests, EMPTY) {
+    DictionaryTrie dict;
+    SuccinctTrie trie(dict);
+    ASSERT_EQ(trie.find("apple"), false);
+    ASSERT_EQ(trie.predictCompletions("a", 2), vector<string>());
+}
+TEST(SuccinctTrieTests, FIND) {
+    DictionaryTrie dict;
+    dict.insert("apple", 5);
+    dict.insert("ape", 3);
+    dict.insert("app", 2);
+    dict.insert("the big apple", 7);
+    SuccinctTrie trie(dict);
+    ASSERT_EQ(trie.size(), 4);
+    ASSERT_EQ(trie.find("apple"), true);
+    ASSERT_EQ(trie.find("app"), true);
+    ASSERT_EQ(trie.find("the big apple"), true);
+    ASSERT_EQ(trie.find("ap"), false);
+    ASSERT_EQ(trie.find("apples"), false);
+    ASSERT_EQ(trie.find(""), false);
+}
+TEST(SuccinctTrieTests, PREDICT_MATCHES_DICTIONARY_TRIE) {
+    DictionaryTrie dict;
+    dict.insert("apple", 5);
+    dict.insert("appendage", 4);
+    dict.insert("ape", 3);
+    dict.insert("apparent", 2);
+    dict.insert("tired", 69);
+    dict.insert("sad", 420);
+    dict.insert("deez", 9000);
+    dict.insert("nuts", 5000);
+    dict.insert("ap", 1);
+    SuccinctTrie trie(dict);
+    for (unsigned int k = 1; k <= 6; k++) {
+        ASSERT_EQ(trie.predictCompletions("ap", k),
+                  dict.predictCompletions("ap", k));
+    }
+    ASSERT_EQ(trie.predictCompletions("d", 3), vector<string>({"deez"}));
+    ASSERT_EQ(trie.predictCompletions("x", 3), vector<string>());
+}
@@ -0,0 +1,62 @@
+/**
+ * This File contains several tests
+ * that check the functionality of the
+ * BloomFilter and WordIndex
+ */
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+#include "WordIndex.hpp"
+
+using namespace std;
+using namespace testing;
+
+/* BLOOM FILTER TESTS */
+TEST(WordIndexTests, BLOOM_NO_FALSE_NEGATIVES) {
+    BloomFilter filter(1000);
+    for (unsigned int i = 0; i < 1000; i++) {
+        filter.add(WordIndex::hash(to_string(i)));
+    }
+    for (unsigned int i = 0; i < 1000; i++) {
+        ASSERT_EQ(filter.mayContain(WordIndex::hash(to_string(i))), true);
+    }
+    // sized for about 1% false positives
+    unsigned int falsePositives = 0;
+    for (unsigned int i = 1000; i < 11000; i++) {
+        falsePositives += filter.mayContain(WordIndex::hash(to_string(i)));
+    }
+    ASSERT_LT(falsePositives, 300);
+}
+
+/* WORD INDEX TESTS */
+TEST(WordIndexTests, INSERT_FREQUENCY) {
+    WordIndex index;
+    ASSERT_EQ(index.contains("apple"), false);
+    ASSERT_EQ(index.insert("apple", 5), true);
+    ASSERT_EQ(index.insert("apple", 6), false);
+    ASSERT_EQ(index.insert("app", 2), true);
+    ASSERT_EQ(index.insert("the big apple", 7), true);
+    ASSERT_EQ(index.insert("", 7), false);
+    ASSERT_EQ(index.insert("zero", 0), false);
+    ASSERT_EQ(index.size(), 3);
+    ASSERT_EQ(index.frequency("apple"), 5);
+    ASSERT_EQ(index.frequency("app"), 2);
+    ASSERT_EQ(index.frequency("the big apple"), 7);
+    ASSERT_EQ(index.frequency("ap"), 0);
+    ASSERT_EQ(index.frequency(""), 0);
+    ASSERT_EQ(index.contains("apples"), false);
+}
+TEST(WordIndexTests, GROWS) {
+    WordIndex index(4);
+    for (unsigned int i = 1; i <= 5000; i++) {
+        ASSERT_EQ(index.insert("word" + to_string(i), i), true);
+    }
+    ASSERT_EQ(index.size(), 5000);
+    for (unsigned int i = 1; i <= 5000; i++) {
+        ASSERT_EQ(index.frequency("word" + to_string(i)), i);
+    }
+    ASSERT_EQ(index.contains("word0"), false);
+    ASSERT_EQ(index.contains("word5001"), false);
+}